@@ -0,0 +1,160 @@
+/*
+
+MIT License
+
+Copyright (c) 2021 Mika Tuupola
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+-cut-
+
+This file is part of the Kendryte K210 HAL for the HAGL graphics library:
+https://github.com/tuupola/hagl_k210_mipi
+
+SPDX-License-Identifier: MIT
+
+-cut-
+
+Alpha blended blits for the buffered HALs. Source bitmap has a separate
+8 or 4 bit alpha plane. Pixels are blended in SWAR fashion, green, red and
+blue are spread apart so they can be blended with one multiply. Two pixels
+with same alpha are blended at once in a 64 bit register. Runs of fully
+transparent pixels are skipped and runs of opaque pixels copied.
+
+*/
+
+#include "hagl_hal.h"
+
+#ifdef HAGL_HAL_USE_ALPHA
+
+#ifndef HAGL_HAS_HAL_BACK_BUFFER
+#error "Alpha blits require a buffered HAL."
+#endif
+
+#include <string.h>
+
+#include <bitmap.h>
+
+#include "hagl_hal_alpha.h"
+
+/* Green on top, red and blue at the bottom, each with room for a multiply. */
+#define HAGL_HAL_ALPHA_SPREAD       (0x07e0f81fULL)
+#define HAGL_HAL_ALPHA_SPREAD2      (0x07e0f81f07e0f81fULL)
+
+/* Alpha is scaled to 0 ... 32. */
+#define HAGL_HAL_ALPHA_OPAQUE       (32)
+
+/* Pixels in the buffer are big endian. */
+static inline uint32_t hagl_hal_alpha_spread(color_t color)
+{
+    uint32_t c = (uint16_t) ((color >> 8) | (color << 8));
+    return (c | (c << 16)) & HAGL_HAL_ALPHA_SPREAD;
+}
+
+static inline color_t hagl_hal_alpha_pack(uint32_t c)
+{
+    uint16_t color = (c >> 16) | c;
+    return (color >> 8) | (color << 8);
+}
+
+/* One pixel in 32 bits. */
+static inline color_t hagl_hal_alpha_blend1(color_t fg, color_t bg, uint32_t a)
+{
+    uint32_t f = hagl_hal_alpha_spread(fg);
+    uint32_t b = hagl_hal_alpha_spread(bg);
+    return hagl_hal_alpha_pack(((((f - b) * a) >> 5) + b) & HAGL_HAL_ALPHA_SPREAD);
+}
+
+/* Two pixels with same alpha in 64 bits. */
+static inline void hagl_hal_alpha_blend2(const color_t *fg, color_t *bg, uint64_t a)
+{
+    uint64_t f = hagl_hal_alpha_spread(fg[0]) | ((uint64_t) hagl_hal_alpha_spread(fg[1]) << 32);
+    uint64_t b = hagl_hal_alpha_spread(bg[0]) | ((uint64_t) hagl_hal_alpha_spread(bg[1]) << 32);
+    uint64_t r = ((((f - b) * a) >> 5) + b) & HAGL_HAL_ALPHA_SPREAD2;
+    bg[0] = hagl_hal_alpha_pack(r);
+    bg[1] = hagl_hal_alpha_pack(r >> 32);
+}
+
+static inline uint8_t hagl_hal_alpha_get(const uint8_t *row, uint16_t x, uint8_t bits)
+{
+    if (8 == bits) {
+        return (row[x] + 4) >> 3;
+    }
+    uint8_t a = (row[x >> 1] >> ((x & 1) ? 0 : 4)) & 0x0f;
+    return (a * 35) >> 4;
+}
+
+static void hagl_hal_alpha_row(color_t *dst, const color_t *src, const uint8_t *alpha, uint16_t sx, uint16_t w, uint8_t bits)
+{
+    uint16_t x = 0;
+
+    while (x < w) {
+        uint8_t a = hagl_hal_alpha_get(alpha, sx + x, bits);
+        uint16_t run = 1;
+
+        if (0 == a || HAGL_HAL_ALPHA_OPAQUE == a) {
+            while (x + run < w && hagl_hal_alpha_get(alpha, sx + x + run, bits) == a) {
+                run++;
+            }
+            if (a) {
+                memcpy(&dst[x], &src[x], run * sizeof(color_t));
+            }
+        } else if (x + 1 < w && hagl_hal_alpha_get(alpha, sx + x + 1, bits) == a) {
+            hagl_hal_alpha_blend2(&src[x], &dst[x], a);
+            run = 2;
+        } else {
+            dst[x] = hagl_hal_alpha_blend1(src[x], dst[x], a);
+        }
+
+        x += run;
+    }
+}
+
+void hagl_hal_alpha_blend(
+    bitmap_t *dst, int16_t x0, int16_t y0, bitmap_t *src, const uint8_t *alpha, uint8_t bits
+) {
+    int32_t x1 = x0 < 0 ? 0 : x0;
+    int32_t y1 = y0 < 0 ? 0 : y0;
+    int32_t x2 = x0 + src->width;
+    int32_t y2 = y0 + src->height;
+    size_t alpha_pitch = 8 == bits ? src->width : (src->width + 1) / 2;
+
+    if (x2 > dst->width) {
+        x2 = dst->width;
+    }
+    if (y2 > dst->height) {
+        y2 = dst->height;
+    }
+    if (x1 >= x2 || y1 >= y2) {
+        return;
+    }
+
+    uint16_t sx = x1 - x0;
+    for (int32_t y = y1; y < y2; y++) {
+        uint16_t sy = y - y0;
+        hagl_hal_alpha_row(
+            (color_t *) (dst->buffer + dst->pitch * y) + x1,
+            (color_t *) (src->buffer + src->pitch * sy) + sx,
+            alpha + alpha_pitch * sy,
+            sx, x2 - x1, bits
+        );
+    }
+}
+
+#endif /* HAGL_HAL_USE_ALPHA */
@@ -0,0 +1,187 @@
+/*
+
+MIT License
+
+Copyright (c) 2021 Mika Tuupola
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+-cut-
+
+This file is part of the Kendryte K210 HAL for the HAGL graphics library:
+https://github.com/tuupola/hagl_k210_mipi
+
+SPDX-License-Identifier: MIT
+
+-cut-
+
+Camera passthrough for the K210 DVP. Camera frames are sent to the display
+straight from the memory DVP writes them to. An optional overlay region is
+taken from a HAGL bitmap, usually the back buffer, and merged row by row
+into the outgoing transfer. The camera frame is never copied or modified.
+
+*/
+
+#include "hagl_hal.h"
+
+#ifdef HAGL_HAL_USE_CAMERA
+
+#ifdef HAGL_HAL_USE_TILES
+#error "Camera overlay expects row ordered back buffer and cannot be used with tiles."
+#endif
+
+#include <string.h>
+#include <mipi_display.h>
+
+#include <bitmap.h>
+
+#include "hagl_hal_camera.h"
+
+static bitmap_t *overlay = NULL;
+static int16_t ox0, oy0;
+static uint16_t ow, oh;
+static uint8_t okeyed;
+static color_t okey;
+
+void hagl_hal_camera_set_overlay(
+    bitmap_t *source, int16_t x0, int16_t y0, uint16_t w, uint16_t h,
+    uint8_t keyed, color_t key
+) {
+    overlay = source;
+    ox0 = x0;
+    oy0 = y0;
+    ow = w;
+    oh = h;
+    okeyed = keyed;
+    okey = key;
+}
+
+/* Send rows y1 ... y2 - 1 of the visible part of the frame. */
+static size_t hagl_hal_camera_rows(bitmap_t *frame, int32_t y1, int32_t y2, size_t size)
+{
+    size_t sent = 0;
+
+    if (size == frame->pitch) {
+        return mipi_display_stream_write(frame->buffer + frame->pitch * y1, frame->pitch * (y2 - y1));
+    }
+    for (int32_t y = y1; y < y2; y++) {
+        sent += mipi_display_stream_write(frame->buffer + frame->pitch * y, size);
+    }
+    return sent;
+}
+
+size_t hagl_hal_camera_write(uint16_t x0, uint16_t y0, bitmap_t *frame)
+{
+    static color_t line[MIPI_DISPLAY_WIDTH];
+
+    size_t sent = 0;
+    int32_t x1 = 0, x2 = 0, y1 = 0, y2 = 0;
+    int32_t width = frame->width;
+    int32_t height = frame->height;
+
+    /* Only the part of the frame which is on the display is sent. */
+    if (x0 >= MIPI_DISPLAY_WIDTH || y0 >= MIPI_DISPLAY_HEIGHT) {
+        return 0;
+    }
+    if (x0 + width > MIPI_DISPLAY_WIDTH) {
+        width = MIPI_DISPLAY_WIDTH - x0;
+    }
+    if (y0 + height > MIPI_DISPLAY_HEIGHT) {
+        height = MIPI_DISPLAY_HEIGHT - y0;
+    }
+
+    size_t size = width * sizeof(color_t);
+
+    /* Overlay region clipped to the visible frame, in frame coordinates. */
+    if (overlay) {
+        x1 = ox0 - x0 < 0 ? 0 : ox0 - x0;
+        y1 = oy0 - y0 < 0 ? 0 : oy0 - y0;
+        x2 = ox0 + ow - x0;
+        y2 = oy0 + oh - y0;
+        if (x2 > width) {
+            x2 = width;
+        }
+        if (y2 > height) {
+            y2 = height;
+        }
+        if (x2 > overlay->width - x0) {
+            x2 = overlay->width - x0;
+        }
+        if (y2 > overlay->height - y0) {
+            y2 = overlay->height - y0;
+        }
+    }
+
+    mipi_display_stream_begin(x0, y0, width, height);
+
+    if (x1 >= x2 || y1 >= y2) {
+        sent = hagl_hal_camera_rows(frame, 0, height, size);
+        mipi_display_stream_end();
+        return sent;
+    }
+
+    /* Rows above the overlay. */
+    if (y1 > 0) {
+        sent += hagl_hal_camera_rows(frame, 0, y1, size);
+    }
+
+    size_t left = x1 * sizeof(color_t);
+    size_t middle = (x2 - x1) * sizeof(color_t);
+    size_t right = size - left - middle;
+
+    for (int32_t y = y1; y < y2; y++) {
+        uint8_t *src = frame->buffer + frame->pitch * y;
+        uint8_t *over = overlay->buffer + overlay->pitch * (y + y0) + (x1 + x0) * sizeof(color_t);
+
+        if (okeyed) {
+            /* Keyed overlay needs a copy of the camera row. */
+            color_t *csrc = (color_t *) src;
+            color_t *cover = (color_t *) over;
+            for (int32_t x = 0; x < width; x++) {
+                line[x] = csrc[x];
+            }
+            for (int32_t x = x1; x < x2; x++) {
+                if (cover[x - x1] != okey) {
+                    line[x] = cover[x - x1];
+                }
+            }
+            sent += mipi_display_stream_write((uint8_t *) line, size);
+        } else {
+            /* Window wraps by itself so the row can be sent in parts. */
+            if (left) {
+                sent += mipi_display_stream_write(src, left);
+            }
+            sent += mipi_display_stream_write(over, middle);
+            if (right) {
+                sent += mipi_display_stream_write(src + left + middle, right);
+            }
+        }
+    }
+
+    /* Rows below the overlay. */
+    if (y2 < height) {
+        sent += hagl_hal_camera_rows(frame, y2, height, size);
+    }
+
+    mipi_display_stream_end();
+
+    return sent;
+}
+
+#endif /* HAGL_HAL_USE_CAMERA */
@@ -0,0 +1,119 @@
+/*
+
+MIT License
+
+Copyright (c) 2021 Mika Tuupola
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+-cut-
+
+This file is part of the Kendryte K210 HAL for the HAGL graphics library:
+https://github.com/tuupola/hagl_k210_mipi
+
+SPDX-License-Identifier: MIT
+
+-cut-
+
+Moving pixels inside a bitmap or between two bitmaps of the same size. Used
+by hagl_hal_copy_area() of the back buffer HALs for scrolling and moving
+windows without redrawing them.
+Rows are copied bottom up when moving down so that overlapping source
+rows are read before they are overwritten. Overlap within a row is
+handled by memmove().
+
+*/
+
+#include <stdbool.h>
+#include <string.h>
+
+#include <bitmap.h>
+
+#include "hagl_hal.h"
+#include "hagl_hal_copy.h"
+#include "hagl_hal_tile.h"
+
+bool hagl_hal_copy_clip(hagl_hal_rect_t *src, int16_t *x1, int16_t *y1, uint16_t width, uint16_t height)
+{
+    int32_t left = src->x0 < *x1 ? src->x0 : *x1;
+    int32_t top = src->y0 < *y1 ? src->y0 : *y1;
+    int32_t right = (src->x0 > *x1 ? src->x0 : *x1) + src->w;
+    int32_t bottom = (src->y0 > *y1 ? src->y0 : *y1) + src->h;
+    int32_t w = src->w;
+    int32_t h = src->h;
+
+    /* Whichever of source or destination sticks out more decides the clip. */
+    if (left < 0) {
+        src->x0 -= left;
+        *x1 -= left;
+        w += left;
+    }
+    if (top < 0) {
+        src->y0 -= top;
+        *y1 -= top;
+        h += top;
+    }
+    if (right > width) {
+        w -= right - width;
+    }
+    if (bottom > height) {
+        h -= bottom - height;
+    }
+    if (w <= 0 || h <= 0) {
+        return false;
+    }
+
+    src->w = w;
+    src->h = h;
+
+    return true;
+}
+
+void hagl_hal_copy_bitmap(
+    bitmap_t *bitmap, const bitmap_t *from, const hagl_hal_rect_t *src, int16_t x1, int16_t y1
+) {
+    int16_t step = 1;
+    uint16_t first = 0;
+
+    /* Moving down, start from the bottom row. */
+    if (y1 > src->y0) {
+        step = -1;
+        first = src->h - 1;
+    }
+
+#ifdef HAGL_HAL_USE_TILES
+    bool backwards = x1 > src->x0;
+    for (uint16_t i = 0, y = first; i < src->h; i++, y += step) {
+        for (uint16_t j = 0; j < src->w; j++) {
+            uint16_t x = backwards ? src->w - 1 - j : j;
+            *hagl_hal_tile_address(bitmap, x1 + x, y1 + y) =
+                *hagl_hal_tile_address((bitmap_t *) from, src->x0 + x, src->y0 + y);
+        }
+    }
+#else
+    size_t size = src->w * (bitmap->depth / 8);
+    for (uint16_t i = 0, y = first; i < src->h; i++, y += step) {
+        memmove(
+            bitmap->buffer + bitmap->pitch * (y1 + y) + (bitmap->depth / 8) * x1,
+            from->buffer + from->pitch * (src->y0 + y) + (from->depth / 8) * src->x0,
+            size
+        );
+    }
+#endif /* HAGL_HAL_USE_TILES */
+}
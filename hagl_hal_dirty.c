@@ -0,0 +1,142 @@
+/*
+
+MIT License
+
+Copyright (c) 2021 Mika Tuupola
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+-cut-
+
+This file is part of the Kendryte K210 HAL for the HAGL graphics library:
+https://github.com/tuupola/hagl_k210_mipi
+
+SPDX-License-Identifier: MIT
+
+-cut-
+
+Dirty rectangle bookkeeping for the back buffer HALs. Areas which need
+to be sent to the display are collected into a small fixed size list.
+Overlapping areas are merged. When the list is full the new area is
+merged to the rectangle which grows the least.
+
+*/
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "hagl_hal.h"
+#include "hagl_hal_dirty.h"
+
+static void hagl_hal_rect_union(hagl_hal_rect_t *a, const hagl_hal_rect_t *b)
+{
+    int32_t x1 = a->x0 < b->x0 ? a->x0 : b->x0;
+    int32_t y1 = a->y0 < b->y0 ? a->y0 : b->y0;
+    int32_t x2 = a->x0 + a->w > b->x0 + b->w ? a->x0 + a->w : b->x0 + b->w;
+    int32_t y2 = a->y0 + a->h > b->y0 + b->h ? a->y0 + a->h : b->y0 + b->h;
+
+    a->x0 = x1;
+    a->y0 = y1;
+    a->w = x2 - x1;
+    a->h = y2 - y1;
+}
+
+/* Overlapping or touching rectangles are cheaper to send as one. */
+static bool hagl_hal_rect_touches(const hagl_hal_rect_t *a, const hagl_hal_rect_t *b)
+{
+    return a->x0 <= b->x0 + b->w && b->x0 <= a->x0 + a->w
+        && a->y0 <= b->y0 + b->h && b->y0 <= a->y0 + a->h;
+}
+
+static uint32_t hagl_hal_rect_growth(const hagl_hal_rect_t *a, const hagl_hal_rect_t *b)
+{
+    hagl_hal_rect_t merged = *a;
+    hagl_hal_rect_union(&merged, b);
+    return merged.w * merged.h - a->w * a->h;
+}
+
+void hagl_hal_dirty_clear(hagl_hal_dirty_t *dirty)
+{
+    dirty->count = 0;
+}
+
+void hagl_hal_dirty_add(hagl_hal_dirty_t *dirty, int16_t x0, int16_t y0, uint16_t w, uint16_t h)
+{
+    int32_t x1 = x0 < 0 ? 0 : x0;
+    int32_t y1 = y0 < 0 ? 0 : y0;
+    int32_t x2 = x0 + w > DISPLAY_WIDTH ? DISPLAY_WIDTH : x0 + w;
+    int32_t y2 = y0 + h > DISPLAY_HEIGHT ? DISPLAY_HEIGHT : y0 + h;
+
+    if (x1 >= x2 || y1 >= y2) {
+        return;
+    }
+
+    hagl_hal_rect_t rect = {
+        .x0 = x1,
+        .y0 = y1,
+        .w = x2 - x1,
+        .h = y2 - y1,
+    };
+
+    for (uint8_t i = 0; i < dirty->count; i++) {
+        if (!hagl_hal_rect_touches(&dirty->rects[i], &rect)) {
+            continue;
+        }
+
+        hagl_hal_rect_union(&dirty->rects[i], &rect);
+
+        /* Grown rectangle might now touch others. Keep merging and */
+        /* always keep the place of the older rectangle. */
+        uint8_t j = 0;
+        while (j < dirty->count) {
+            if (j != i && hagl_hal_rect_touches(&dirty->rects[i], &dirty->rects[j])) {
+                uint8_t keep = j < i ? j : i;
+                uint8_t drop = j < i ? i : j;
+                hagl_hal_rect_union(&dirty->rects[keep], &dirty->rects[drop]);
+                memmove(
+                    &dirty->rects[drop], &dirty->rects[drop + 1],
+                    (dirty->count - drop - 1) * sizeof(hagl_hal_rect_t)
+                );
+                dirty->count--;
+                i = keep;
+                j = 0;
+            } else {
+                j++;
+            }
+        }
+        return;
+    }
+
+    if (dirty->count < HAGL_HAL_DIRTY_COUNT) {
+        dirty->rects[dirty->count++] = rect;
+        return;
+    }
+
+    /* List is full. Merge to the rectangle which grows the least. */
+    uint8_t best = 0;
+    uint32_t growth = UINT32_MAX;
+    for (uint8_t i = 0; i < dirty->count; i++) {
+        uint32_t candidate = hagl_hal_rect_growth(&dirty->rects[i], &rect);
+        if (candidate < growth) {
+            growth = candidate;
+            best = i;
+        }
+    }
+    hagl_hal_rect_union(&dirty->rects[best], &rect);
+}
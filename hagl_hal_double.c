@@ -45,6 +45,7 @@ valid.
 
 #ifdef HAGL_HAL_USE_DOUBLE_BUFFER
 
+#include <stdbool.h>
 #include <string.h>
 #include <mipi_display.h>
 #include <mipi_dcs.h>
@@ -52,10 +53,25 @@ valid.
 #include <bitmap.h>
 #include <hagl.h>
 
+#include "hagl_hal_dirty.h"
+#include "hagl_hal_copy.h"
+#include "hagl_hal_layer.h"
+#include "hagl_hal_sprite.h"
+#include "hagl_hal_alpha.h"
+#include "hagl_hal_tile.h"
+#include "hagl_hal_upscale.h"
+#include "hagl_hal_interlace.h"
+
 #include <stdio.h>
 #include <stdlib.h>
 
-static uint8_t buffer[BITMAP_SIZE(DISPLAY_WIDTH, DISPLAY_HEIGHT, DISPLAY_DEPTH)];
+#if defined(HAGL_HAL_BUFFER_ADDRESS)
+static uint8_t *buffer = (uint8_t *) (HAGL_HAL_BUFFER_ADDRESS);
+#elif defined(HAGL_HAL_USE_EXTERNAL_BUFFER)
+static uint8_t *buffer = NULL;
+#else
+static uint8_t buffer[BITMAP_SIZE(DISPLAY_WIDTH, DISPLAY_HEIGHT, DISPLAY_DEPTH)] HAGL_HAL_BUFFER_ATTRIBUTE;
+#endif
 
 static bitmap_t fb = {
     .width = DISPLAY_WIDTH,
@@ -63,56 +79,320 @@ static bitmap_t fb = {
     .depth = DISPLAY_DEPTH,
 };
 
+/* Bitmap the drawing primitives currently write to. */
+static bitmap_t *target = &fb;
+
+#ifdef HAGL_HAL_USE_INLINE_PIXEL
+color_t *hagl_hal_buffer = NULL;
+#endif /* HAGL_HAL_USE_INLINE_PIXEL */
+
+#ifdef HAGL_HAL_USE_DIRTY
+#ifdef HAGL_HAL_USE_LAYERS
+#error "Layers always flush the whole screen and cannot be used with HAGL_HAL_USE_DIRTY."
+#endif
+static hagl_hal_dirty_t dirty;
+static hagl_hal_rect_t focus;
+#endif /* HAGL_HAL_USE_DIRTY */
+
+#ifdef HAGL_HAL_USE_EXTERNAL_BUFFER
+void hagl_hal_set_buffer(uint8_t *memory)
+{
+    buffer = memory;
+}
+#endif /* HAGL_HAL_USE_EXTERNAL_BUFFER */
+
 bitmap_t *hagl_hal_init(void)
 {
+#ifdef HAGL_HAL_USE_EXTERNAL_BUFFER
+    if (NULL == buffer) {
+        hagl_hal_debug("%s\n", "Back buffer has not been set.");
+        return NULL;
+    }
+#endif /* HAGL_HAL_USE_EXTERNAL_BUFFER */
+
     mipi_display_init();
     bitmap_init(&fb, buffer);
+#ifdef HAGL_HAL_USE_INLINE_PIXEL
+    hagl_hal_buffer = (color_t *) fb.buffer;
+#endif /* HAGL_HAL_USE_INLINE_PIXEL */
+
+    hagl_hal_debug("Back buffer address is %p\n", (void *) buffer);
+
+#ifdef HAGL_HAL_USE_DIRTY
+    /* First flush sends everything. */
+    hagl_hal_dirty_add(&dirty, 0, 0, fb.width, fb.height);
+#endif /* HAGL_HAL_USE_DIRTY */
 
     return &fb;
 }
 
+size_t hagl_hal_flush_rect(int16_t x0, int16_t y0, uint16_t w, uint16_t h)
+{
+#if defined(HAGL_HAL_USE_TILES)
+    return hagl_hal_tile_write(&fb, x0, y0, w, h);
+#elif HAGL_HAL_UPSCALE > 1
+    return hagl_hal_upscale_write(&fb, x0, y0, w, h);
+#else
+    uint8_t *ptr = fb.buffer + fb.pitch * y0 + (fb.depth / 8) * x0;
+    return mipi_display_write_pitch(x0, y0, w, h, fb.pitch, ptr);
+#endif /* HAGL_HAL_USE_TILES */
+}
+
+#ifdef HAGL_HAL_USE_DIRTY
+void hagl_hal_mark_dirty(int16_t x0, int16_t y0, uint16_t w, uint16_t h)
+{
+    hagl_hal_dirty_add(&dirty, x0, y0, w, h);
+}
+
+static size_t hagl_hal_flush_dirty()
+{
+    size_t sent = 0;
+
+    for (uint8_t i = 0; i < dirty.count; i++) {
+        hagl_hal_rect_t *rect = &dirty.rects[i];
+        sent += hagl_hal_flush_rect(rect->x0, rect->y0, rect->w, rect->h);
+    }
+    hagl_hal_dirty_clear(&dirty);
+
+    return sent;
+}
+
+void hagl_hal_set_focus(int16_t x0, int16_t y0, uint16_t w, uint16_t h)
+{
+    focus.x0 = x0;
+    focus.y0 = y0;
+    focus.w = w;
+    focus.h = h;
+}
+
+static bool hagl_hal_focused(const hagl_hal_rect_t *rect)
+{
+    return focus.w && focus.h
+        && rect->x0 < focus.x0 + focus.w && focus.x0 < rect->x0 + rect->w
+        && rect->y0 < focus.y0 + focus.h && focus.y0 < rect->y0 + rect->h;
+}
+
+/*
+Send as many whole rows as fit the budget but at least min rows. Rectangle
+shrinks to the unsent rows.
+*/
+static size_t hagl_hal_flush_rows(hagl_hal_rect_t *rect, size_t budget, size_t min)
+{
+    size_t row = rect->w * HAGL_HAL_UPSCALE * HAGL_HAL_UPSCALE * (fb.depth / 8);
+    size_t rows = budget / row;
+    size_t sent;
+
+    if (rows < min) {
+        rows = min;
+    }
+
+    if (rows > rect->h) {
+        rows = rect->h;
+    }
+    if (0 == rows) {
+        return 0;
+    }
+
+    sent = hagl_hal_flush_rect(rect->x0, rect->y0, rect->w, rows);
+    rect->y0 += rows;
+    rect->h -= rows;
+
+    return sent;
+}
+
+size_t hagl_hal_flush_budget(size_t budget)
+{
+    size_t sent = 0;
+    bool full = false;
+    uint8_t count = 0;
+
+    HAGL_HAL_TRACE_BEGIN("hagl_hal_flush_budget");
+#ifdef HAGL_HAL_USE_SPRITES
+    hagl_hal_sprite_draw(&fb, &dirty);
+#endif /* HAGL_HAL_USE_SPRITES */
+
+    /* First pass sends the focused areas, second pass the rest. */
+    for (uint8_t pass = 0; pass < 2 && !full; pass++) {
+        for (uint8_t i = 0; i < dirty.count && !full; i++) {
+            hagl_hal_rect_t *rect = &dirty.rects[i];
+            if (hagl_hal_focused(rect) != (0 == pass)) {
+                continue;
+            }
+            /* First row always goes out so a budget smaller than a row cannot stall. */
+            sent += hagl_hal_flush_rows(rect, sent >= budget ? 0 : budget - sent, 0 == sent ? 1 : 0);
+            /* Stop at the first area which did not fit to keep the priority order. */
+            full = rect->h > 0 || sent >= budget;
+        }
+    }
+
+    /* Unsent rows are carried over to the next call in the same order. */
+    for (uint8_t i = 0; i < dirty.count; i++) {
+        if (dirty.rects[i].h > 0) {
+            dirty.rects[count++] = dirty.rects[i];
+        }
+    }
+    dirty.count = count;
+
+#ifdef HAGL_HAL_USE_SPRITES
+    hagl_hal_sprite_restore(&fb);
+#endif /* HAGL_HAL_USE_SPRITES */
+    HAGL_HAL_TRACE_END("hagl_hal_flush_budget");
+
+    return sent;
+}
+#endif /* HAGL_HAL_USE_DIRTY */
+
 size_t hagl_hal_flush()
 {
+    size_t sent;
+
+    HAGL_HAL_TRACE_BEGIN("hagl_hal_flush");
+#if defined(HAGL_HAL_USE_LAYERS)
+    /* Back buffer is the cached background below the overlay layers. */
+    sent = hagl_hal_layer_flush(&fb);
+#elif defined(HAGL_HAL_USE_DIRTY)
+#ifdef HAGL_HAL_USE_SPRITES
+    hagl_hal_sprite_draw(&fb, &dirty);
+#endif /* HAGL_HAL_USE_SPRITES */
+    /* Flush only the areas which have changed. */
+    sent = hagl_hal_flush_dirty();
+#ifdef HAGL_HAL_USE_SPRITES
+    hagl_hal_sprite_restore(&fb);
+#endif /* HAGL_HAL_USE_SPRITES */
+#else
     /* Flush the whole back buffer. */
-    return mipi_display_write(0, 0, fb.width, fb.height, (uint8_t *) fb.buffer);
+#if defined(HAGL_HAL_USE_TILES)
+    sent = hagl_hal_tile_write(&fb, 0, 0, fb.width, fb.height);
+#elif HAGL_HAL_UPSCALE > 1
+    sent = hagl_hal_upscale_write(&fb, 0, 0, fb.width, fb.height);
+#elif defined(HAGL_HAL_USE_INTERLACE)
+    sent = hagl_hal_interlace_flush(&fb);
+#else
+    sent = mipi_display_write(0, 0, fb.width, fb.height, (uint8_t *) fb.buffer);
+#endif /* HAGL_HAL_USE_TILES */
+#endif
+    HAGL_HAL_TRACE_END("hagl_hal_flush");
+
+    return sent;
 }
 
+#if defined(HAGL_HAL_USE_LAYERS) || defined(HAGL_HAL_USE_SURFACES)
+void hagl_hal_set_target(bitmap_t *bitmap)
+{
+    if (NULL == bitmap) {
+        target = &fb;
+    } else {
+        target = bitmap;
+    }
+    /* Primitives are not clipped by the HAL so let HAGL do it. */
+    hagl_set_clip_window(0, 0, target->width - 1, target->height - 1);
+}
+#endif /* HAGL_HAL_USE_LAYERS || HAGL_HAL_USE_SURFACES */
+
+void hagl_hal_copy_area(int16_t x0, int16_t y0, uint16_t w, uint16_t h, int16_t x1, int16_t y1)
+{
+    hagl_hal_rect_t src = {.x0 = x0, .y0 = y0, .w = w, .h = h};
+
+    if (!hagl_hal_copy_clip(&src, &x1, &y1, target->width, target->height)) {
+        return;
+    }
+    hagl_hal_copy_bitmap(target, target, &src, x1, y1);
+
+#ifdef HAGL_HAL_USE_DIRTY
+    /* Only the destination changed. */
+    if (target == &fb) {
+        hagl_hal_dirty_add(&dirty, x1, y1, src.w, src.h);
+    }
+#endif /* HAGL_HAL_USE_DIRTY */
+}
+
+#ifndef HAGL_HAL_USE_INLINE_PIXEL
 void hagl_hal_put_pixel(int16_t x0, int16_t y0, color_t color)
 {
-    color_t *ptr = (color_t *) (fb.buffer + fb.pitch * y0 + (fb.depth / 8) * x0);
+#ifdef HAGL_HAL_USE_TILES
+    *hagl_hal_tile_address(target, x0, y0) = color;
+#else
+    color_t *ptr = (color_t *) (target->buffer + target->pitch * y0 + (target->depth / 8) * x0);
     *ptr = color;
+#endif /* HAGL_HAL_USE_TILES */
+}
+#endif /* HAGL_HAL_USE_INLINE_PIXEL */
+
+void hagl_hal_put_pixels(const point_t *points, const color_t *colors, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        int16_t x0 = points[i].x;
+        int16_t y0 = points[i].y;
+        if (x0 < 0 || y0 < 0 || x0 >= target->width || y0 >= target->height) {
+            continue;
+        }
+#ifdef HAGL_HAL_USE_TILES
+        *hagl_hal_tile_address(target, x0, y0) = colors[i];
+#else
+        ((color_t *) (target->buffer + target->pitch * y0))[x0] = colors[i];
+#endif /* HAGL_HAL_USE_TILES */
+    }
 }
 
+#ifndef HAGL_HAL_USE_INLINE_PIXEL
 color_t hagl_hal_get_pixel(int16_t x0, int16_t y0)
 {
-    return *(color_t *) (fb.buffer + fb.pitch * y0 + (fb.depth / 8) * x0);
+#ifdef HAGL_HAL_USE_TILES
+    return *hagl_hal_tile_address(target, x0, y0);
+#else
+    return *(color_t *) (target->buffer + target->pitch * y0 + (target->depth / 8) * x0);
+#endif /* HAGL_HAL_USE_TILES */
 }
+#endif /* HAGL_HAL_USE_INLINE_PIXEL */
 
 void hagl_hal_blit(uint16_t x0, uint16_t y0, bitmap_t *src)
 {
-    bitmap_blit(x0, y0, src, &fb);
+#ifdef HAGL_HAL_USE_TILES
+    hagl_hal_tile_blit(target, x0, y0, src);
+#else
+    bitmap_blit(x0, y0, src, target);
+#endif /* HAGL_HAL_USE_TILES */
+}
+
+#ifdef HAGL_HAL_USE_ALPHA
+void hagl_hal_alpha_blit(int16_t x0, int16_t y0, bitmap_t *src, const uint8_t *alpha, uint8_t bits)
+{
+    hagl_hal_alpha_blend(target, x0, y0, src, alpha, bits);
 }
+#endif /* HAGL_HAL_USE_ALPHA */
 
 void hagl_hal_scale_blit(uint16_t x0, uint16_t y0, uint16_t w, uint16_t h, bitmap_t *src)
 {
-    bitmap_scale_blit(x0, y0, w, h, src, &fb);
+#ifdef HAGL_HAL_USE_TILES
+    hagl_hal_tile_scale_blit(target, x0, y0, w, h, src);
+#else
+    bitmap_scale_blit(x0, y0, w, h, src, target);
+#endif /* HAGL_HAL_USE_TILES */
 }
 
 void hagl_hal_hline(int16_t x0, int16_t y0, uint16_t width, color_t color)
 {
-    color_t *ptr = (color_t *) (fb.buffer + fb.pitch * y0 + (fb.depth / 8) * x0);
+#ifdef HAGL_HAL_USE_TILES
+    hagl_hal_tile_hline(target, x0, y0, width, color);
+#else
+    color_t *ptr = (color_t *) (target->buffer + target->pitch * y0 + (target->depth / 8) * x0);
     for (uint16_t x = 0; x < width; x++) {
         *ptr++ = color;
     }
+#endif /* HAGL_HAL_USE_TILES */
 }
 
 void hagl_hal_vline(int16_t x0, int16_t y0, uint16_t height, color_t color)
 {
-    color_t *ptr = (color_t *) (fb.buffer + fb.pitch * y0 + (fb.depth / 8) * x0);
+#ifdef HAGL_HAL_USE_TILES
+    hagl_hal_tile_vline(target, x0, y0, height, color);
+#else
+    color_t *ptr = (color_t *) (target->buffer + target->pitch * y0 + (target->depth / 8) * x0);
     for (uint16_t y = 0; y < height; y++) {
         *ptr = color;
-        ptr += fb.pitch / (fb.depth / 8);
+        ptr += target->pitch / (target->depth / 8);
     }
+#endif /* HAGL_HAL_USE_TILES */
 }
 
 #endif /* HAGL_HAL_USE_DOUBLE_BUFFER */
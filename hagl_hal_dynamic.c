@@ -0,0 +1,296 @@
+/*
+
+MIT License
+
+Copyright (c) 2021 Mika Tuupola
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+-cut-
+
+This file is part of the Kendryte K210 HAL for the HAGL graphics library:
+https://github.com/tuupola/hagl_k210_mipi
+
+SPDX-License-Identifier: MIT
+
+-cut-
+
+This is the HAL used when buffering mode is selected at runtime. Memory
+for the back buffers is given by the caller. Single buffering needs no
+memory, double buffering needs one and triple buffering two back buffers.
+Mode can be changed at any time without initializing the display again,
+for example to lend the memory to the KPU for a while.
+
+Note that all coordinates are already clipped in the main library itself.
+HAL does not need to validate the coordinates, they can alway be assumed
+valid.
+
+*/
+
+#include "hagl_hal.h"
+
+#ifdef HAGL_HAL_USE_DYNAMIC_BUFFER
+
+#include <string.h>
+#include <mipi_display.h>
+#include <mipi_dcs.h>
+
+#include <bitmap.h>
+#include <hagl.h>
+
+#include "hagl_hal_alpha.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static uint8_t mode = HAGL_HAL_MODE_SINGLE;
+static uint8_t *buffer1 = NULL;
+static uint8_t *buffer2 = NULL;
+
+static bitmap_t bb = {
+    .width = DISPLAY_WIDTH,
+    .height = DISPLAY_HEIGHT,
+    .depth = DISPLAY_DEPTH,
+};
+
+bitmap_t *hagl_hal_init(void)
+{
+    mipi_display_init();
+    bitmap_init(&bb, NULL);
+
+    return &bb;
+}
+
+int8_t hagl_hal_set_mode(uint8_t new_mode, uint8_t *memory, size_t size)
+{
+    const size_t buffer_size = BITMAP_SIZE(DISPLAY_WIDTH, DISPLAY_HEIGHT, DISPLAY_DEPTH);
+
+    if (new_mode < HAGL_HAL_MODE_SINGLE || new_mode > HAGL_HAL_MODE_TRIPLE) {
+        return -1;
+    }
+    if (size < (size_t) HAGL_HAL_MODE_SIZE(new_mode)) {
+        return -1;
+    }
+
+    /* Triple buffering swaps on flush, remember which buffer was drawn. */
+    uint8_t *drawn = bb.buffer;
+
+    /* Make sure the display shows what has been drawn so far. */
+    hagl_hal_flush();
+
+    if (HAGL_HAL_MODE_SINGLE == new_mode) {
+        buffer1 = NULL;
+        buffer2 = NULL;
+        bb.buffer = NULL;
+    } else {
+        /* Carry the back buffer over between double and triple buffering. */
+        if (HAGL_HAL_MODE_SINGLE != mode && drawn != memory) {
+            memmove(memory, drawn, buffer_size);
+        }
+        buffer1 = memory;
+        buffer2 = HAGL_HAL_MODE_TRIPLE == new_mode ? memory + buffer_size : NULL;
+        bb.buffer = buffer1;
+    }
+
+    hagl_hal_debug("Switched from %d to %d buffers.\n", mode, new_mode);
+    mode = new_mode;
+
+    return 0;
+}
+
+uint8_t hagl_hal_get_mode(void)
+{
+    return mode;
+}
+
+size_t hagl_hal_flush()
+{
+    uint8_t *buffer = bb.buffer;
+    size_t sent = 0;
+
+    HAGL_HAL_TRACE_BEGIN("hagl_hal_flush");
+    switch (mode) {
+        case HAGL_HAL_MODE_DOUBLE:
+            /* Flush the whole back buffer. */
+            sent = mipi_display_write(0, 0, bb.width, bb.height, buffer);
+            break;
+        case HAGL_HAL_MODE_TRIPLE:
+            bb.buffer = bb.buffer == buffer1 ? buffer2 : buffer1;
+            /* Flush the current back buffer. */
+            sent = mipi_display_write(0, 0, bb.width, bb.height, buffer);
+            break;
+    }
+    HAGL_HAL_TRACE_END("hagl_hal_flush");
+
+    return sent;
+}
+
+void hagl_hal_put_pixel(int16_t x0, int16_t y0, color_t color)
+{
+    if (HAGL_HAL_MODE_SINGLE == mode) {
+        mipi_display_write(x0, y0, 1, 1, (uint8_t *) &color);
+        return;
+    }
+
+    color_t *ptr = (color_t *) (bb.buffer + bb.pitch * y0 + (bb.depth / 8) * x0);
+    *ptr = color;
+}
+
+void hagl_hal_put_pixels(const point_t *points, const color_t *colors, size_t count)
+{
+    static color_t line[DISPLAY_WIDTH];
+    size_t i = 0;
+
+    while (i < count) {
+        int16_t x0 = points[i].x;
+        int16_t y0 = points[i].y;
+        uint16_t w = 0;
+
+        if (x0 < 0 || y0 < 0 || x0 >= DISPLAY_WIDTH || y0 >= DISPLAY_HEIGHT) {
+            i++;
+            continue;
+        }
+
+        if (HAGL_HAL_MODE_SINGLE != mode) {
+            ((color_t *) (bb.buffer + bb.pitch * y0))[x0] = colors[i++];
+            continue;
+        }
+
+        /* Consecutive pixels on the same row are sent together. */
+        while (i < count && points[i].y == y0 && points[i].x == x0 + w && x0 + w < DISPLAY_WIDTH) {
+            line[w++] = colors[i++];
+        }
+        mipi_display_write(x0, y0, w, 1, (uint8_t *) line);
+    }
+}
+
+color_t hagl_hal_get_pixel(int16_t x0, int16_t y0)
+{
+    if (HAGL_HAL_MODE_SINGLE == mode) {
+        return 0x0000;
+    }
+
+    return *(color_t *) (bb.buffer + bb.pitch * y0 + (bb.depth / 8) * x0);
+}
+
+void hagl_hal_blit(uint16_t x0, uint16_t y0, bitmap_t *src)
+{
+    if (HAGL_HAL_MODE_SINGLE == mode) {
+        mipi_display_write(x0, y0, src->width, src->height, (uint8_t *) src->buffer);
+        return;
+    }
+
+    bitmap_blit(x0, y0, src, &bb);
+}
+
+#ifdef HAGL_HAL_USE_ALPHA
+void hagl_hal_alpha_blit(int16_t x0, int16_t y0, bitmap_t *src, const uint8_t *alpha, uint8_t bits)
+{
+    /* There is nothing to blend with in single buffered mode. */
+    if (HAGL_HAL_MODE_SINGLE != mode) {
+        hagl_hal_alpha_blend(&bb, x0, y0, src, alpha, bits);
+    }
+}
+#endif /* HAGL_HAL_USE_ALPHA */
+
+void hagl_hal_scale_blit(uint16_t x0, uint16_t y0, uint16_t w, uint16_t h, bitmap_t *src)
+{
+    static color_t line[DISPLAY_WIDTH];
+
+    if (HAGL_HAL_MODE_SINGLE != mode) {
+        bitmap_scale_blit(x0, y0, w, h, src, &bb);
+        return;
+    }
+
+    if (0 == w || 0 == h) {
+        return;
+    }
+
+    /* Nearest neighbour, one scaled row at a time into a single window. */
+    uint32_t x_ratio = (uint32_t) ((src->width << 16) / w);
+    uint32_t y_ratio = (uint32_t) ((src->height << 16) / h);
+
+    /* HAGL does not clip scaled blits. Negative coordinates arrive as large unsigned. */
+    int32_t x1 = (int16_t) x0 < 0 ? 0 : (int16_t) x0;
+    int32_t y1 = (int16_t) y0 < 0 ? 0 : (int16_t) y0;
+    int32_t x2 = (int16_t) x0 + w > DISPLAY_WIDTH ? DISPLAY_WIDTH : (int16_t) x0 + w;
+    int32_t y2 = (int16_t) y0 + h > DISPLAY_HEIGHT ? DISPLAY_HEIGHT : (int16_t) y0 + h;
+
+    if (x1 >= x2 || y1 >= y2) {
+        return;
+    }
+
+    /* Clipped left and top parts are skipped in the source too. */
+    uint32_t ox = x1 - (int16_t) x0;
+    uint32_t oy = y1 - (int16_t) y0;
+
+    x0 = x1;
+    y0 = y1;
+    w = x2 - x1;
+    h = y2 - y1;
+
+    mipi_display_stream_begin(x0, y0, w, h);
+    for (uint16_t y = 0; y < h; y++) {
+        color_t *row = (color_t *) (src->buffer + src->pitch * (((y + oy) * y_ratio) >> 16));
+        for (uint16_t x = 0; x < w; x++) {
+            line[x] = row[((x + ox) * x_ratio) >> 16];
+        }
+        mipi_display_stream_write((uint8_t *) line, w * sizeof(color_t));
+    }
+    mipi_display_stream_end();
+}
+
+void hagl_hal_hline(int16_t x0, int16_t y0, uint16_t width, color_t color)
+{
+    static color_t line[DISPLAY_WIDTH];
+
+    if (HAGL_HAL_MODE_SINGLE == mode) {
+        for (uint16_t x = 0; x < width; x++) {
+            line[x] = color;
+        }
+        mipi_display_write(x0, y0, width, 1, (uint8_t *) line);
+        return;
+    }
+
+    color_t *ptr = (color_t *) (bb.buffer + bb.pitch * y0 + (bb.depth / 8) * x0);
+    for (uint16_t x = 0; x < width; x++) {
+        *ptr++ = color;
+    }
+}
+
+void hagl_hal_vline(int16_t x0, int16_t y0, uint16_t height, color_t color)
+{
+    static color_t line[DISPLAY_HEIGHT];
+
+    if (HAGL_HAL_MODE_SINGLE == mode) {
+        for (uint16_t y = 0; y < height; y++) {
+            line[y] = color;
+        }
+        mipi_display_write(x0, y0, 1, height, (uint8_t *) line);
+        return;
+    }
+
+    color_t *ptr = (color_t *) (bb.buffer + bb.pitch * y0 + (bb.depth / 8) * x0);
+    for (uint16_t y = 0; y < height; y++) {
+        *ptr = color;
+        ptr += bb.pitch / (bb.depth / 8);
+    }
+}
+
+#endif /* HAGL_HAL_USE_DYNAMIC_BUFFER */
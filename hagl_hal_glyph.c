@@ -0,0 +1,184 @@
+/*
+
+MIT License
+
+Copyright (c) 2021 Mika Tuupola
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+-cut-
+
+This file is part of the Kendryte K210 HAL for the HAGL graphics library:
+https://github.com/tuupola/hagl_k210_mipi
+
+SPDX-License-Identifier: MIT
+
+-cut-
+
+Glyph cache. Each glyph and color pair is rasterized once into a RGB565
+bitmap stored in a fixed size cache. Least recently used glyph is evicted
+when the cache is full. Cached glyphs are drawn with a single blit which
+in single buffered mode is one window write to the display.
+
+*/
+
+#include "hagl_hal.h"
+
+#ifdef HAGL_HAL_USE_GLYPH_CACHE
+
+#include <string.h>
+
+#include <bitmap.h>
+#include <fontx.h>
+#include <hagl.h>
+
+#include "hagl_hal_glyph.h"
+
+typedef struct {
+    const uint8_t *font;
+    wchar_t code;
+    color_t color;
+    uint8_t width;
+    uint8_t height;
+    /* Zero means the slot is empty. */
+    uint32_t used;
+    color_t pixels[HAGL_HAL_GLYPH_MAX_WIDTH * HAGL_HAL_GLYPH_MAX_HEIGHT];
+} hagl_hal_glyph_t;
+
+static hagl_hal_glyph_t cache[HAGL_HAL_GLYPH_CACHE_COUNT];
+static uint32_t tick = 0;
+
+void hagl_hal_glyph_clear(void)
+{
+    for (uint16_t i = 0; i < HAGL_HAL_GLYPH_CACHE_COUNT; i++) {
+        cache[i].used = 0;
+    }
+}
+
+/* Returns the matching glyph or the least recently used slot. */
+static hagl_hal_glyph_t *hagl_hal_glyph_find(wchar_t code, color_t color, const uint8_t *font)
+{
+    hagl_hal_glyph_t *oldest = &cache[0];
+
+    for (uint16_t i = 0; i < HAGL_HAL_GLYPH_CACHE_COUNT; i++) {
+        hagl_hal_glyph_t *glyph = &cache[i];
+        if (glyph->used
+            && glyph->code == code
+            && glyph->color == color
+            && glyph->font == font
+        ) {
+            return glyph;
+        }
+        if (glyph->used < oldest->used) {
+            oldest = glyph;
+        }
+    }
+
+    return oldest;
+}
+
+static uint8_t hagl_hal_glyph_render(
+    hagl_hal_glyph_t *slot, wchar_t code, color_t color, const uint8_t *font
+) {
+    fontx_glyph_t glyph;
+
+    if (0 != fontx_glyph(&glyph, code, font)) {
+        return 1;
+    }
+
+    if (glyph.width > HAGL_HAL_GLYPH_MAX_WIDTH || glyph.height > HAGL_HAL_GLYPH_MAX_HEIGHT) {
+        return 1;
+    }
+
+    /* Same rasterization as hagl_put_char(). */
+    color_t *ptr = slot->pixels;
+    for (uint8_t y = 0; y < glyph.height; y++) {
+        for (uint8_t x = 0; x < glyph.width; x++) {
+            if (glyph.buffer[x / 8] & (0x80 >> (x % 8))) {
+                *(ptr++) = color;
+            } else {
+                *(ptr++) = 0x0000;
+            }
+        }
+        glyph.buffer += glyph.pitch;
+    }
+
+    slot->font = font;
+    slot->code = code;
+    slot->color = color;
+    slot->width = glyph.width;
+    slot->height = glyph.height;
+
+    return 0;
+}
+
+uint8_t hagl_hal_put_char(wchar_t code, int16_t x0, int16_t y0, color_t color, const uint8_t *font)
+{
+    hagl_hal_glyph_t *glyph = hagl_hal_glyph_find(code, color, font);
+
+    if (!glyph->used || glyph->code != code || glyph->color != color || glyph->font != font) {
+        glyph->used = 0;
+        if (0 != hagl_hal_glyph_render(glyph, code, color, font)) {
+            return hagl_put_char(code, x0, y0, color, font);
+        }
+    }
+    glyph->used = ++tick;
+
+    if (x0 < 0 || y0 < 0
+        || x0 + glyph->width > DISPLAY_WIDTH
+        || y0 + glyph->height > DISPLAY_HEIGHT
+    ) {
+        return hagl_put_char(code, x0, y0, color, font);
+    }
+
+    bitmap_t bitmap = {
+        .width = glyph->width,
+        .height = glyph->height,
+        .depth = DISPLAY_DEPTH,
+    };
+    bitmap_init(&bitmap, (uint8_t *) glyph->pixels);
+    hagl_hal_blit(x0, y0, &bitmap);
+
+    return glyph->width;
+}
+
+uint16_t hagl_hal_put_text(const wchar_t *str, int16_t x0, int16_t y0, color_t color, const uint8_t *font)
+{
+    wchar_t temp;
+    fontx_meta_t meta;
+    uint16_t original = x0;
+
+    if (0 != fontx_meta(&meta, font)) {
+        return 0;
+    }
+
+    do {
+        temp = *str++;
+        if (13 == temp || 10 == temp) {
+            x0 = 0;
+            y0 += meta.height;
+        } else {
+            x0 += hagl_hal_put_char(temp, x0, y0, color, font);
+        }
+    } while (*str != 0);
+
+    return x0 - original;
+}
+
+#endif /* HAGL_HAL_USE_GLYPH_CACHE */
@@ -0,0 +1,261 @@
+/*
+
+MIT License
+
+Copyright (c) 2021 Mika Tuupola
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+-cut-
+
+This file is part of the Kendryte K210 HAL for the HAGL graphics library:
+https://github.com/tuupola/hagl_k210_mipi
+
+SPDX-License-Identifier: MIT
+
+-cut-
+
+Streaming image decoders. Compressed images are decoded a band of rows at
+a time into a small buffer which is then sent to the display, or to the
+back buffer when buffering is enabled. There is no need for a full size
+bitmap. Supported formats are QOI and a simple RLE compressed RGB565.
+
+*/
+
+#include "hagl_hal.h"
+
+#ifdef HAGL_HAL_USE_IMAGE
+
+#include <stdbool.h>
+#include <string.h>
+#include <mipi_display.h>
+
+#include <bitmap.h>
+
+#include "hagl_hal_image.h"
+
+/*
+Without buffering the bands are streamed into one address window. Decoding
+and sending take turns, the next band is decoded only after the previous one
+has been sent. When drawing must go through the HAL the bands are blitted
+instead.
+*/
+#if defined(HAGL_HAS_HAL_BACK_BUFFER) || defined(HAGL_HAL_USE_QUEUE) || defined(HAGL_HAL_USE_VIEWPORTS)
+#define HAGL_HAL_IMAGE_USE_BLIT
+#endif
+
+typedef struct {
+    int16_t x0;
+    int16_t y0;
+    uint16_t w;
+    uint16_t h;
+    /* Rows sent so far. */
+    uint16_t y;
+    /* Pixels in the current band. */
+    uint32_t count;
+} hagl_hal_image_t;
+
+static color_t lines[DISPLAY_WIDTH * HAGL_HAL_IMAGE_LINES];
+
+static bool hagl_hal_image_begin(hagl_hal_image_t *image, int16_t x0, int16_t y0, uint16_t w, uint16_t h)
+{
+    if (x0 < 0 || y0 < 0 || 0 == w || 0 == h || x0 + w > DISPLAY_WIDTH || y0 + h > DISPLAY_HEIGHT) {
+        return false;
+    }
+
+    image->x0 = x0;
+    image->y0 = y0;
+    image->w = w;
+    image->h = h;
+    image->y = 0;
+    image->count = 0;
+
+#ifndef HAGL_HAL_IMAGE_USE_BLIT
+    mipi_display_stream_begin(x0, y0, w, h);
+#endif /* HAGL_HAL_IMAGE_USE_BLIT */
+
+    return true;
+}
+
+static void hagl_hal_image_send(hagl_hal_image_t *image)
+{
+    uint16_t rows = image->count / image->w;
+
+    if (0 == rows) {
+        return;
+    }
+
+#ifdef HAGL_HAL_IMAGE_USE_BLIT
+    bitmap_t band = {
+        .width = image->w,
+        .height = rows,
+        .depth = DISPLAY_DEPTH,
+    };
+    bitmap_init(&band, (uint8_t *) lines);
+    hagl_hal_blit(image->x0, image->y0 + image->y, &band);
+#else
+    mipi_display_stream_write((uint8_t *) lines, image->count * sizeof(color_t));
+#endif /* HAGL_HAL_IMAGE_USE_BLIT */
+
+    image->y += rows;
+    image->count = 0;
+}
+
+/* Returns false when the image is complete. */
+static inline bool hagl_hal_image_put(hagl_hal_image_t *image, color_t color)
+{
+    lines[image->count++] = color;
+
+    if (image->count == (uint32_t) image->w * HAGL_HAL_IMAGE_LINES) {
+        hagl_hal_image_send(image);
+    }
+
+    return image->y + image->count / image->w < image->h;
+}
+
+static int8_t hagl_hal_image_end(hagl_hal_image_t *image)
+{
+    hagl_hal_image_send(image);
+
+#ifndef HAGL_HAL_IMAGE_USE_BLIT
+    mipi_display_stream_end();
+#endif /* HAGL_HAL_IMAGE_USE_BLIT */
+
+    /* Truncated data is an error, but what was decoded is still shown. */
+    return image->y == image->h ? 0 : -1;
+}
+
+int8_t hagl_hal_image_rle(
+    int16_t x0, int16_t y0, uint16_t w, uint16_t h, const uint8_t *data, size_t size
+) {
+    hagl_hal_image_t image;
+    const uint8_t *end = data + size;
+    bool more = true;
+
+    if (!hagl_hal_image_begin(&image, x0, y0, w, h)) {
+        return -1;
+    }
+
+    while (more && data < end) {
+        uint8_t header = *data++;
+        uint8_t count = (header & 0x7f) + 1;
+
+        if (header & 0x80) {
+            color_t color;
+            if (data + 2 > end) {
+                break;
+            }
+            memcpy(&color, data, 2);
+            data += 2;
+            while (count-- && more) {
+                more = hagl_hal_image_put(&image, color);
+            }
+        } else {
+            while (count-- && more && data + 2 <= end) {
+                color_t color;
+                memcpy(&color, data, 2);
+                data += 2;
+                more = hagl_hal_image_put(&image, color);
+            }
+        }
+    }
+
+    return hagl_hal_image_end(&image);
+}
+
+/* RGB888 to big endian RGB565 as stored in memory. */
+static inline color_t hagl_hal_image_rgb565(uint8_t r, uint8_t g, uint8_t b)
+{
+    uint16_t color = ((r & 0xf8) << 8) | ((g & 0xfc) << 3) | (b >> 3);
+    return (color >> 8) | (color << 8);
+}
+
+int8_t hagl_hal_image_qoi(int16_t x0, int16_t y0, const uint8_t *data, size_t size)
+{
+    hagl_hal_image_t image;
+    uint8_t index[64][4];
+    uint8_t px[4] = {0, 0, 0, 255};
+    const uint8_t *end;
+    bool more = true;
+
+    /* Header is 14 bytes and the end marker 8 bytes. */
+    if (size < 22 || memcmp(data, "qoif", 4)) {
+        return -1;
+    }
+
+    uint32_t w = (data[4] << 24) | (data[5] << 16) | (data[6] << 8) | data[7];
+    uint32_t h = (data[8] << 24) | (data[9] << 16) | (data[10] << 8) | data[11];
+
+    if (w > DISPLAY_WIDTH || h > DISPLAY_HEIGHT) {
+        return -1;
+    }
+    if (!hagl_hal_image_begin(&image, x0, y0, w, h)) {
+        return -1;
+    }
+
+    memset(index, 0, sizeof(index));
+    end = data + size - 8;
+    data += 14;
+
+    while (more && data < end) {
+        uint8_t op = *data++;
+        uint8_t run = 1;
+
+        if (0xfe == op) {
+            /* QOI_OP_RGB */
+            px[0] = data[0];
+            px[1] = data[1];
+            px[2] = data[2];
+            data += 3;
+        } else if (0xff == op) {
+            /* QOI_OP_RGBA */
+            memcpy(px, data, 4);
+            data += 4;
+        } else if (0x00 == (op & 0xc0)) {
+            /* QOI_OP_INDEX */
+            memcpy(px, index[op], 4);
+        } else if (0x40 == (op & 0xc0)) {
+            /* QOI_OP_DIFF */
+            px[0] += ((op >> 4) & 0x03) - 2;
+            px[1] += ((op >> 2) & 0x03) - 2;
+            px[2] += (op & 0x03) - 2;
+        } else if (0x80 == (op & 0xc0)) {
+            /* QOI_OP_LUMA */
+            uint8_t next = *data++;
+            int8_t vg = (op & 0x3f) - 32;
+            px[0] += vg - 8 + ((next >> 4) & 0x0f);
+            px[1] += vg;
+            px[2] += vg - 8 + (next & 0x0f);
+        } else {
+            /* QOI_OP_RUN */
+            run = (op & 0x3f) + 1;
+        }
+
+        memcpy(index[(px[0] * 3 + px[1] * 5 + px[2] * 7 + px[3] * 11) & 0x3f], px, 4);
+
+        color_t color = hagl_hal_image_rgb565(px[0], px[1], px[2]);
+        while (run-- && more) {
+            more = hagl_hal_image_put(&image, color);
+        }
+    }
+
+    return hagl_hal_image_end(&image);
+}
+
+#endif /* HAGL_HAL_USE_IMAGE */
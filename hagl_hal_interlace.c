@@ -0,0 +1,94 @@
+/*
+
+MIT License
+
+Copyright (c) 2021 Mika Tuupola
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+-cut-
+
+This file is part of the Kendryte K210 HAL for the HAGL graphics library:
+https://github.com/tuupola/hagl_k210_mipi
+
+SPDX-License-Identifier: MIT
+
+-cut-
+
+Interlaced flush for the double and triple buffered HALs. When enabled
+each flush sends only every other row, even rows on one frame and odd
+rows on the next. Moving content gets twice the update rate and static
+content is complete after two flushes.
+
+*/
+
+#include "hagl_hal.h"
+
+#ifdef HAGL_HAL_USE_INTERLACE
+
+#if defined(HAGL_HAL_USE_DYNAMIC_BUFFER) || !defined(HAGL_HAS_HAL_BACK_BUFFER)
+#error "Interlacing requires HAGL_HAL_USE_DOUBLE_BUFFER or HAGL_HAL_USE_TRIPLE_BUFFER."
+#endif
+#if defined(HAGL_HAL_USE_LAYERS) || defined(HAGL_HAL_USE_TILES) || HAGL_HAL_UPSCALE > 1
+#error "Layers, tiles and upscaling have their own flush and cannot be interlaced."
+#endif
+#ifdef HAGL_HAL_USE_DIRTY
+#error "Dirty rectangles and interlacing cannot be used together."
+#endif
+
+#include <mipi_display.h>
+
+#include <bitmap.h>
+
+#include "hagl_hal_interlace.h"
+
+static uint8_t enabled = 0;
+static uint8_t field = 0;
+
+void hagl_hal_set_interlace(uint8_t enable)
+{
+    enabled = enable;
+    field = 0;
+}
+
+size_t hagl_hal_interlace_flush(bitmap_t *src)
+{
+    size_t size = src->width * (src->depth / 8);
+    size_t sent = 0;
+
+    if (!enabled) {
+        return mipi_display_write(0, 0, src->width, src->height, src->buffer);
+    }
+
+    /*
+     * Window is one row high. Column address stays the same so only the
+     * page address and memory write commands are sent for each row.
+     */
+    for (uint16_t y = field; y < src->height; y += 2) {
+        mipi_display_stream_begin(0, y, src->width, 1);
+        sent += mipi_display_stream_write(src->buffer + src->pitch * y, size);
+        mipi_display_stream_end();
+    }
+
+    field ^= 1;
+
+    return sent;
+}
+
+#endif /* HAGL_HAL_USE_INTERLACE */
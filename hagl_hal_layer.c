@@ -0,0 +1,200 @@
+/*
+
+MIT License
+
+Copyright (c) 2021 Mika Tuupola
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+-cut-
+
+This file is part of the Kendryte K210 HAL for the HAGL graphics library:
+https://github.com/tuupola/hagl_k210_mipi
+
+SPDX-License-Identifier: MIT
+
+-cut-
+
+Layer compositor for the double buffered HAL. The back buffer is used as
+a cached background which is drawn once. Overlay layers are composited on
+top of it row by row while flushing, straight into the outgoing transfer.
+The back buffer itself is never modified by the compositor.
+
+*/
+
+#include "hagl_hal.h"
+
+#ifdef HAGL_HAL_USE_LAYERS
+
+#ifndef HAGL_HAL_USE_DOUBLE_BUFFER
+#error "Layers require HAGL_HAL_USE_DOUBLE_BUFFER."
+#endif
+
+#include <stdbool.h>
+#include <string.h>
+#include <mipi_display.h>
+
+#include <bitmap.h>
+
+#include "hagl_hal_layer.h"
+
+static hagl_hal_layer_t *layers[HAGL_HAL_LAYER_COUNT];
+static uint8_t count = 0;
+
+void hagl_hal_layer_add(hagl_hal_layer_t *layer)
+{
+    if (count < HAGL_HAL_LAYER_COUNT) {
+        layers[count++] = layer;
+    }
+}
+
+void hagl_hal_layer_remove(hagl_hal_layer_t *layer)
+{
+    for (uint8_t i = 0; i < count; i++) {
+        if (layers[i] == layer) {
+            /* Keep the stacking order of the remaining layers. */
+            memmove(&layers[i], &layers[i + 1], (count - i - 1) * sizeof(layers[0]));
+            count--;
+            return;
+        }
+    }
+}
+
+/* Does any visible layer cover rows y0 ... y0 + height - 1? */
+static bool hagl_hal_layer_covers(int32_t y0, int32_t height)
+{
+    for (uint8_t i = 0; i < count; i++) {
+        hagl_hal_layer_t *layer = layers[i];
+        if (layer->visible
+            && layer->y0 < y0 + height
+            && layer->y0 + layer->bitmap->height > y0
+        ) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void hagl_hal_layer_compose(
+    hagl_hal_layer_t *layer, color_t *lines, int32_t y0, int32_t height, int32_t width
+) {
+    bitmap_t *bitmap = layer->bitmap;
+
+    /* Clip the layer against the screen and the current rows. */
+    int32_t x1 = layer->x0 < 0 ? 0 : layer->x0;
+    int32_t x2 = layer->x0 + bitmap->width;
+    int32_t y1 = layer->y0 < y0 ? y0 : layer->y0;
+    int32_t y2 = layer->y0 + bitmap->height;
+
+    if (x2 > width) {
+        x2 = width;
+    }
+    if (y2 > y0 + height) {
+        y2 = y0 + height;
+    }
+    if (x1 >= x2 || y1 >= y2) {
+        return;
+    }
+
+    uint16_t sx = x1 - layer->x0;
+    uint16_t w = x2 - x1;
+    uint16_t mask_pitch = (bitmap->width + 7) / 8;
+
+    for (int32_t y = y1; y < y2; y++) {
+        uint16_t sy = y - layer->y0;
+        color_t *dst = lines + (y - y0) * width + x1;
+        color_t *src = (color_t *) (bitmap->buffer + bitmap->pitch * sy) + sx;
+
+        switch (layer->mode) {
+            case HAGL_HAL_LAYER_COLOR_KEY:
+                for (uint16_t x = 0; x < w; x++) {
+                    if (src[x] != layer->key) {
+                        dst[x] = src[x];
+                    }
+                }
+                break;
+            case HAGL_HAL_LAYER_MASK: {
+                const uint8_t *mask = layer->mask + mask_pitch * sy;
+                for (uint16_t x = 0; x < w; x++) {
+                    uint16_t bit = sx + x;
+                    if (mask[bit >> 3] & (0x80 >> (bit & 7))) {
+                        dst[x] = src[x];
+                    }
+                }
+                break;
+            }
+            default:
+                memcpy(dst, src, w * sizeof(color_t));
+        }
+    }
+}
+
+size_t hagl_hal_layer_flush(bitmap_t *background)
+{
+    static color_t lines[DISPLAY_WIDTH * HAGL_HAL_LAYER_LINES];
+
+    size_t sent = 0;
+    int32_t direct = 0;
+    int32_t height = HAGL_HAL_LAYER_LINES;
+
+    mipi_display_stream_begin(0, 0, background->width, background->height);
+
+    for (int32_t y0 = 0; y0 < background->height; y0 += height) {
+        if (y0 + height > background->height) {
+            height = background->height - y0;
+        }
+
+        /* Uncovered rows are collected and sent straight from the background. */
+        if (!hagl_hal_layer_covers(y0, height)) {
+            continue;
+        }
+
+        if (direct < y0) {
+            sent += mipi_display_stream_write(
+                background->buffer + background->pitch * direct,
+                background->pitch * (y0 - direct)
+            );
+        }
+
+        size_t size = background->pitch * height;
+        memcpy(lines, background->buffer + background->pitch * y0, size);
+
+        for (uint8_t i = 0; i < count; i++) {
+            if (layers[i]->visible) {
+                hagl_hal_layer_compose(layers[i], lines, y0, height, background->width);
+            }
+        }
+
+        sent += mipi_display_stream_write((uint8_t *) lines, size);
+        direct = y0 + height;
+    }
+
+    if (direct < background->height) {
+        sent += mipi_display_stream_write(
+            background->buffer + background->pitch * direct,
+            background->pitch * (background->height - direct)
+        );
+    }
+
+    mipi_display_stream_end();
+
+    return sent;
+}
+
+#endif /* HAGL_HAL_USE_LAYERS */
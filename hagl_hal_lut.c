@@ -0,0 +1,156 @@
+/*
+
+MIT License
+
+Copyright (c) 2021 Mika Tuupola
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+-cut-
+
+This file is part of the Kendryte K210 HAL for the HAGL graphics library:
+https://github.com/tuupola/hagl_k210_mipi
+
+SPDX-License-Identifier: MIT
+
+-cut-
+
+Color lookup table and brightness. When the display controller supports
+MIPI_DCS_WRITE_LUT or MIPI_DCS_SET_DISPLAY_BRIGHTNESS the change costs
+only a few command bytes. Otherwise the same effect is applied in software
+to the pixels on their way to the display. Back buffer is never modified.
+
+*/
+
+#include "hagl_hal.h"
+
+#ifdef HAGL_HAL_USE_LUT
+
+#include <math.h>
+#include <stdbool.h>
+#include <mipi_display.h>
+#include <mipi_dcs.h>
+
+#include "hagl_hal_lut.h"
+
+static uint8_t lut[HAGL_HAL_LUT_SIZE];
+static uint8_t brightness = 255;
+static bool identity = true;
+
+/* Software tables with brightness applied, values in RGB565 positions. */
+static uint16_t red[32];
+static uint16_t green[64];
+static uint16_t blue[32];
+
+/* Pixels are big endian RGB565. */
+static void hagl_hal_lut_transform(uint8_t *dst, const uint8_t *src, size_t size, void *ctx)
+{
+    (void) ctx;
+
+    for (size_t i = 0; i < size; i += 2) {
+        uint16_t color = (src[i] << 8) | src[i + 1];
+        color = red[color >> 11] | green[(color >> 5) & 0x3f] | blue[color & 0x1f];
+        dst[i] = color >> 8;
+        dst[i + 1] = color & 0xff;
+    }
+}
+
+static void hagl_hal_lut_update()
+{
+    uint8_t level = brightness;
+    bool table = !identity;
+
+#ifdef MIPI_DISPLAY_HAS_BRIGHTNESS
+    level = 255;
+#endif /* MIPI_DISPLAY_HAS_BRIGHTNESS */
+#ifdef MIPI_DISPLAY_HAS_LUT
+    table = false;
+#endif /* MIPI_DISPLAY_HAS_LUT */
+
+    /* Controller does everything, nothing to do in software. */
+    if (255 == level && !table) {
+        mipi_display_set_transform(NULL, NULL);
+        return;
+    }
+
+    /* Table entries are six bits. */
+    for (uint8_t i = 0; i < 64; i++) {
+        uint8_t g = table ? lut[32 + i] : i;
+        green[i] = (uint16_t) (g * level / 255) << 5;
+    }
+    for (uint8_t i = 0; i < 32; i++) {
+        uint8_t r = table ? lut[i] : i << 1;
+        uint8_t b = table ? lut[96 + i] : i << 1;
+        red[i] = (uint16_t) (r * level / 255 >> 1) << 11;
+        blue[i] = b * level / 255 >> 1;
+    }
+
+    mipi_display_set_transform(hagl_hal_lut_transform, NULL);
+}
+
+void hagl_hal_lut_gamma(uint8_t *table, float gamma)
+{
+    for (uint8_t i = 0; i < 32; i++) {
+        uint8_t value = 63.0f * powf(i / 31.0f, gamma) + 0.5f;
+        table[i] = value;
+        table[96 + i] = value;
+    }
+    for (uint8_t i = 0; i < 64; i++) {
+        table[32 + i] = 63.0f * powf(i / 63.0f, gamma) + 0.5f;
+    }
+}
+
+void hagl_hal_set_lut(const uint8_t *table)
+{
+    identity = (NULL == table);
+
+    if (identity) {
+        hagl_hal_lut_gamma(lut, 1.0f);
+    } else {
+        for (uint8_t i = 0; i < HAGL_HAL_LUT_SIZE; i++) {
+            lut[i] = table[i];
+        }
+    }
+
+#ifdef MIPI_DISPLAY_HAS_LUT
+    mipi_display_ioctl(MIPI_DCS_WRITE_LUT, lut, HAGL_HAL_LUT_SIZE);
+#endif /* MIPI_DISPLAY_HAS_LUT */
+
+    hagl_hal_lut_update();
+}
+
+void hagl_hal_set_brightness(uint8_t level)
+{
+    brightness = level;
+
+#ifdef MIPI_DISPLAY_HAS_BRIGHTNESS
+    static bool enabled = false;
+    if (!enabled) {
+        /* Enable brightness control and backlight. */
+        uint8_t control = 0x24;
+        mipi_display_ioctl(MIPI_DCS_WRITE_CONTROL_DISPLAY, &control, 1);
+        enabled = true;
+    }
+    mipi_display_ioctl(MIPI_DCS_SET_DISPLAY_BRIGHTNESS, &level, 1);
+#endif /* MIPI_DISPLAY_HAS_BRIGHTNESS */
+
+    hagl_hal_lut_update();
+}
+
+#endif /* HAGL_HAL_USE_LUT */
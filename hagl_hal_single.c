@@ -44,32 +44,161 @@ valid.
 
 #ifdef HAGL_HAL_USE_SINGLE_BUFFER
 
+#include <stdbool.h>
+#include <string.h>
+
 #include <bitmap.h>
 #include <hagl.h>
 
 #include "mipi_display.h"
+#include "hagl_hal_copy.h"
 
-bitmap_t *hagl_hal_init(void)
+#ifdef HAGL_HAL_USE_VIEWPORTS
+static hagl_hal_viewport_t *viewports[HAGL_HAL_VIEWPORT_COUNT];
+static uint8_t viewport_count = 0;
+
+void hagl_hal_viewport_add(hagl_hal_viewport_t *viewport)
 {
-    mipi_display_init();
-    return NULL;
+    if (viewport_count < HAGL_HAL_VIEWPORT_COUNT) {
+        viewports[viewport_count++] = viewport;
+    }
 }
 
-void hagl_hal_put_pixel(int16_t x0, int16_t y0, color_t color)
+void hagl_hal_viewport_remove(hagl_hal_viewport_t *viewport)
+{
+    for (uint8_t i = 0; i < viewport_count; i++) {
+        if (viewports[i] == viewport) {
+            memmove(&viewports[i], &viewports[i + 1], (viewport_count - i - 1) * sizeof(viewports[0]));
+            viewport_count--;
+            return;
+        }
+    }
+}
+
+/* Does the rectangle touch any viewport? */
+static bool hagl_hal_viewport_hit(int16_t x0, int16_t y0, uint16_t w, uint16_t h)
 {
+    for (uint8_t i = 0; i < viewport_count; i++) {
+        hagl_hal_viewport_t *viewport = viewports[i];
+        if (viewport->x0 < x0 + w
+            && viewport->x0 + viewport->bitmap->width > x0
+            && viewport->y0 < y0 + h
+            && viewport->y0 + viewport->bitmap->height > y0
+        ) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+Split the rectangle row by row into segments. Segments inside a viewport
+go to its buffer, the rest straight to GRAM. When pixels is NULL the
+rectangle is filled with color instead.
+*/
+static void hagl_hal_viewport_write(
+    int16_t x0, int16_t y0, uint16_t w, uint16_t h, const color_t *pixels, color_t color
+) {
+    static color_t line[DISPLAY_WIDTH];
+
+    if (NULL == pixels) {
+        for (uint16_t x = 0; x < w; x++) {
+            line[x] = color;
+        }
+    }
+
+    for (int16_t y = y0; y < y0 + h; y++) {
+        const color_t *src = pixels ? pixels + (y - y0) * w : line;
+        int16_t x = x0;
+
+        while (x < x0 + w) {
+            hagl_hal_viewport_t *hit = NULL;
+            int16_t end = x0 + w;
+
+            for (uint8_t i = 0; i < viewport_count; i++) {
+                hagl_hal_viewport_t *viewport = viewports[i];
+                if (y < viewport->y0 || y >= viewport->y0 + viewport->bitmap->height) {
+                    continue;
+                }
+                if (x >= viewport->x0 && x < viewport->x0 + viewport->bitmap->width) {
+                    hit = viewport;
+                    break;
+                }
+                /* GRAM segment ends where the next viewport starts. */
+                if (viewport->x0 > x && viewport->x0 < end) {
+                    end = viewport->x0;
+                }
+            }
+
+            if (hit) {
+                bitmap_t *bitmap = hit->bitmap;
+                if (hit->x0 + bitmap->width < end) {
+                    end = hit->x0 + bitmap->width;
+                }
+                memcpy(
+                    bitmap->buffer + bitmap->pitch * (y - hit->y0) + (x - hit->x0) * sizeof(color_t),
+                    src + (x - x0),
+                    (end - x) * sizeof(color_t)
+                );
+            } else {
+                mipi_display_write(x, y, end - x, 1, (uint8_t *) (src + (x - x0)));
+            }
+
+            x = end;
+        }
+    }
+}
+
+static size_t hagl_hal_viewport_flush()
+{
+    size_t sent = 0;
+
+    for (uint8_t i = 0; i < viewport_count; i++) {
+        bitmap_t *bitmap = viewports[i]->bitmap;
+        sent += mipi_display_write_pitch(
+            viewports[i]->x0, viewports[i]->y0, bitmap->width, bitmap->height,
+            bitmap->pitch, bitmap->buffer
+        );
+    }
+
+    return sent;
+}
+#endif /* HAGL_HAL_USE_VIEWPORTS */
+
+static void hagl_hal_write_pixel(int16_t x0, int16_t y0, color_t color)
+{
+#ifdef HAGL_HAL_USE_VIEWPORTS
+    if (hagl_hal_viewport_hit(x0, y0, 1, 1)) {
+        hagl_hal_viewport_write(x0, y0, 1, 1, NULL, color);
+        return;
+    }
+#endif /* HAGL_HAL_USE_VIEWPORTS */
     mipi_display_write(x0, y0, 1, 1, (uint8_t *) &color);
 }
 
-void hagl_hal_blit(uint16_t x0, uint16_t y0, bitmap_t *src)
+static void hagl_hal_write_blit(uint16_t x0, uint16_t y0, uint16_t w, uint16_t h, color_t *buffer)
 {
-    mipi_display_write(x0, y0, src->width, src->height, (uint8_t *) src->buffer);
+#ifdef HAGL_HAL_USE_VIEWPORTS
+    if (hagl_hal_viewport_hit(x0, y0, w, h)) {
+        hagl_hal_viewport_write(x0, y0, w, h, buffer, 0);
+        return;
+    }
+#endif /* HAGL_HAL_USE_VIEWPORTS */
+    mipi_display_write(x0, y0, w, h, (uint8_t *) buffer);
 }
 
-void hagl_hal_hline(int16_t x0, int16_t y0, uint16_t width, color_t color)
+static void hagl_hal_write_hline(int16_t x0, int16_t y0, uint16_t width, color_t color)
 {
     static color_t line[DISPLAY_WIDTH];
     const uint16_t height = 1;
 
+#ifdef HAGL_HAL_USE_VIEWPORTS
+    if (hagl_hal_viewport_hit(x0, y0, width, height)) {
+        hagl_hal_viewport_write(x0, y0, width, height, NULL, color);
+        return;
+    }
+#endif /* HAGL_HAL_USE_VIEWPORTS */
+
     for (uint16_t x = 0; x < width; x++) {
         line[x] = color;
 
@@ -78,11 +207,18 @@ void hagl_hal_hline(int16_t x0, int16_t y0, uint16_t width, color_t color)
     mipi_display_write(x0, y0, width, height, (uint8_t *) line);
 }
 
-void hagl_hal_vline(int16_t x0, int16_t y0, uint16_t height, color_t color)
+static void hagl_hal_write_vline(int16_t x0, int16_t y0, uint16_t height, color_t color)
 {
     static color_t line[DISPLAY_HEIGHT];
     const uint16_t width = 1;
 
+#ifdef HAGL_HAL_USE_VIEWPORTS
+    if (hagl_hal_viewport_hit(x0, y0, width, height)) {
+        hagl_hal_viewport_write(x0, y0, width, height, NULL, color);
+        return;
+    }
+#endif /* HAGL_HAL_USE_VIEWPORTS */
+
     for (uint16_t y = 0; y < height; y++) {
         line[y] = color;
     }
@@ -90,4 +226,484 @@ void hagl_hal_vline(int16_t x0, int16_t y0, uint16_t height, color_t color)
     mipi_display_write(x0, y0, width, height, (uint8_t *) line);
 }
 
+#ifdef HAGL_HAL_USE_QUEUE
+
+#if (HAGL_HAL_QUEUE_SIZE & (HAGL_HAL_QUEUE_SIZE - 1))
+#error "HAGL_HAL_QUEUE_SIZE must be a power of two."
+#endif
+#if (HAGL_HAL_QUEUE_DATA_SIZE & (HAGL_HAL_QUEUE_DATA_SIZE - 1))
+#error "HAGL_HAL_QUEUE_DATA_SIZE must be a power of two."
+#endif
+
+#define HAGL_HAL_QUEUE_PIXEL    (0)
+#define HAGL_HAL_QUEUE_HLINE    (1)
+#define HAGL_HAL_QUEUE_VLINE    (2)
+#define HAGL_HAL_QUEUE_BLIT     (3)
+
+typedef struct {
+    uint8_t type;
+    int16_t x0;
+    int16_t y0;
+    uint16_t w;
+    uint16_t h;
+    color_t color;
+    /* Position of blit pixels in the data ring. */
+    uint32_t data;
+    /* Data ring is free up to here once the command is done. */
+    uint32_t end;
+} hagl_hal_command_t;
+
+/*
+Single producer single consumer rings. Head is written only by the
+producer and tail only by the consumer. Counters run freely and are
+masked when indexing.
+*/
+static hagl_hal_command_t commands[HAGL_HAL_QUEUE_SIZE];
+static uint32_t command_head = 0;
+static uint32_t command_tail = 0;
+
+/* Blitted pixels are copied so the caller can reuse the bitmap. */
+static color_t data[HAGL_HAL_QUEUE_DATA_SIZE];
+static uint32_t data_head = 0;
+static uint32_t data_tail = 0;
+
+static uint32_t dropped = 0;
+
+static void hagl_hal_queue_execute(hagl_hal_command_t *command)
+{
+    switch (command->type) {
+        case HAGL_HAL_QUEUE_PIXEL:
+            hagl_hal_write_pixel(command->x0, command->y0, command->color);
+            break;
+        case HAGL_HAL_QUEUE_HLINE:
+            hagl_hal_write_hline(command->x0, command->y0, command->w, command->color);
+            break;
+        case HAGL_HAL_QUEUE_VLINE:
+            hagl_hal_write_vline(command->x0, command->y0, command->h, command->color);
+            break;
+        case HAGL_HAL_QUEUE_BLIT:
+            hagl_hal_write_blit(
+                command->x0, command->y0, command->w, command->h,
+                &data[command->data & (HAGL_HAL_QUEUE_DATA_SIZE - 1)]
+            );
+            break;
+    }
+}
+
+/* Returns false if the command was dropped. */
+static bool hagl_hal_queue_push(hagl_hal_command_t *command, bitmap_t *src)
+{
+    uint32_t head = command_head;
+    uint32_t start = data_head;
+    uint32_t end = data_head;
+
+    if (src) {
+        uint32_t size = src->width * src->height;
+        uint32_t offset = start & (HAGL_HAL_QUEUE_DATA_SIZE - 1);
+        uint32_t limit = HAGL_HAL_QUEUE_DATA_SIZE;
+        uint32_t used;
+
+        /* Would never fit, callers send these directly instead. */
+        if (size > HAGL_HAL_QUEUE_DATA_SIZE) {
+            return false;
+        }
+
+        /*
+         * Pixels must be contiguous, skip the tail end of the ring if needed.
+         * Pixels then go to the start of the ring and the pixels still in use
+         * must all be between them and the skipped tail end.
+         */
+        if (offset + size > HAGL_HAL_QUEUE_DATA_SIZE) {
+            start += HAGL_HAL_QUEUE_DATA_SIZE - offset;
+            limit = offset;
+        }
+        end = start + size;
+
+        while (1) {
+            used = data_head - __atomic_load_n(&data_tail, __ATOMIC_ACQUIRE);
+            if (0 == used || used + size <= limit) {
+                break;
+            }
+#ifdef HAGL_HAL_QUEUE_DROP
+            dropped++;
+            return false;
+#endif /* HAGL_HAL_QUEUE_DROP */
+        }
+    }
+
+    while (head - __atomic_load_n(&command_tail, __ATOMIC_ACQUIRE) == HAGL_HAL_QUEUE_SIZE) {
+#ifdef HAGL_HAL_QUEUE_DROP
+        dropped++;
+        return false;
+#endif /* HAGL_HAL_QUEUE_DROP */
+    }
+
+    if (src) {
+        memcpy(&data[start & (HAGL_HAL_QUEUE_DATA_SIZE - 1)], src->buffer, (end - start) * sizeof(color_t));
+        data_head = end;
+    }
+
+    command->data = start;
+    command->end = end;
+    commands[head & (HAGL_HAL_QUEUE_SIZE - 1)] = *command;
+    __atomic_store_n(&command_head, head + 1, __ATOMIC_RELEASE);
+
+    return true;
+}
+
+void hagl_hal_queue_process(void)
+{
+    uint32_t tail = command_tail;
+
+    while (tail != __atomic_load_n(&command_head, __ATOMIC_ACQUIRE)) {
+        hagl_hal_command_t *command = &commands[tail & (HAGL_HAL_QUEUE_SIZE - 1)];
+
+        hagl_hal_queue_execute(command);
+
+        __atomic_store_n(&data_tail, command->end, __ATOMIC_RELEASE);
+        __atomic_store_n(&command_tail, ++tail, __ATOMIC_RELEASE);
+    }
+}
+
+int hagl_hal_queue_core1(void *ctx)
+{
+    (void) ctx;
+
+    while (1) {
+        hagl_hal_queue_process();
+    }
+
+    return 0;
+}
+
+void hagl_hal_queue_wait(void)
+{
+    while (__atomic_load_n(&command_tail, __ATOMIC_ACQUIRE) != command_head) {
+    }
+}
+
+uint32_t hagl_hal_queue_dropped(void)
+{
+    return dropped;
+}
+
+#endif /* HAGL_HAL_USE_QUEUE */
+
+#if defined(HAGL_HAL_USE_QUEUE) || defined(HAGL_HAL_USE_VIEWPORTS)
+size_t hagl_hal_flush()
+{
+    size_t sent = 0;
+
+    HAGL_HAL_TRACE_BEGIN("hagl_hal_flush");
+#ifdef HAGL_HAL_USE_QUEUE
+    hagl_hal_queue_wait();
+#endif /* HAGL_HAL_USE_QUEUE */
+#ifdef HAGL_HAL_USE_VIEWPORTS
+    /* Only buffered viewports are sent, rest is already in GRAM. */
+    sent = hagl_hal_viewport_flush();
+#endif /* HAGL_HAL_USE_VIEWPORTS */
+    HAGL_HAL_TRACE_END("hagl_hal_flush");
+
+    return sent;
+}
+#endif
+
+bitmap_t *hagl_hal_init(void)
+{
+    mipi_display_init();
+    return NULL;
+}
+
+void hagl_hal_put_pixel(int16_t x0, int16_t y0, color_t color)
+{
+#ifdef HAGL_HAL_USE_QUEUE
+    hagl_hal_command_t command = {
+        .type = HAGL_HAL_QUEUE_PIXEL, .x0 = x0, .y0 = y0, .color = color
+    };
+    hagl_hal_queue_push(&command, NULL);
+#else
+    hagl_hal_write_pixel(x0, y0, color);
+#endif /* HAGL_HAL_USE_QUEUE */
+}
+
+void hagl_hal_put_pixels(const point_t *points, const color_t *colors, size_t count)
+{
+    static color_t line[DISPLAY_WIDTH];
+    bitmap_t run = {
+        .height = 1,
+        .depth = DISPLAY_DEPTH,
+    };
+    size_t i = 0;
+
+    while (i < count) {
+        int16_t x0 = points[i].x;
+        int16_t y0 = points[i].y;
+        uint16_t w = 0;
+
+        if (x0 < 0 || y0 < 0 || x0 >= DISPLAY_WIDTH || y0 >= DISPLAY_HEIGHT) {
+            i++;
+            continue;
+        }
+
+        /* Consecutive pixels on the same row are sent together. */
+        while (i < count && points[i].y == y0 && points[i].x == x0 + w && x0 + w < DISPLAY_WIDTH) {
+            line[w++] = colors[i++];
+        }
+
+        if (1 == w) {
+            hagl_hal_put_pixel(x0, y0, line[0]);
+        } else {
+            run.width = w;
+            bitmap_init(&run, (uint8_t *) line);
+            hagl_hal_blit(x0, y0, &run);
+        }
+    }
+}
+
+void hagl_hal_blit(uint16_t x0, uint16_t y0, bitmap_t *src)
+{
+#ifdef HAGL_HAL_USE_QUEUE
+    /* Bitmaps bigger than the data ring are sent directly. */
+    if (src->width * src->height > HAGL_HAL_QUEUE_DATA_SIZE) {
+        hagl_hal_queue_wait();
+        hagl_hal_write_blit(x0, y0, src->width, src->height, (color_t *) src->buffer);
+        return;
+    }
+
+    hagl_hal_command_t command = {
+        .type = HAGL_HAL_QUEUE_BLIT, .x0 = x0, .y0 = y0, .w = src->width, .h = src->height
+    };
+    hagl_hal_queue_push(&command, src);
+#else
+    hagl_hal_write_blit(x0, y0, src->width, src->height, (color_t *) src->buffer);
+#endif /* HAGL_HAL_USE_QUEUE */
+}
+
+typedef struct {
+    uint16_t x0;
+    uint16_t y0;
+    uint16_t w;
+    uint16_t h;
+} hagl_hal_span_t;
+
+static void hagl_hal_write_span(int16_t x0, int16_t y0, bitmap_t *src, hagl_hal_span_t *span)
+{
+    uint8_t *buffer = src->buffer + src->pitch * span->y0 + span->x0 * sizeof(color_t);
+
+#ifdef HAGL_HAL_USE_VIEWPORTS
+    if (hagl_hal_viewport_hit(x0 + span->x0, y0 + span->y0, span->w, span->h)) {
+        for (uint16_t y = 0; y < span->h; y++) {
+            hagl_hal_write_blit(
+                x0 + span->x0, y0 + span->y0 + y, span->w, 1,
+                (color_t *) (buffer + src->pitch * y)
+            );
+        }
+        return;
+    }
+#endif /* HAGL_HAL_USE_VIEWPORTS */
+
+    mipi_display_write_pitch(x0 + span->x0, y0 + span->y0, span->w, span->h, src->pitch, buffer);
+}
+
+void hagl_hal_blit_keyed(uint16_t ux0, uint16_t uy0, bitmap_t *src, color_t key)
+{
+    /* Rectangles still growing downwards, sorted by x. */
+    static hagl_hal_span_t spans[2][DISPLAY_WIDTH / 2 + 1];
+    hagl_hal_span_t *open = spans[0];
+    hagl_hal_span_t *next = spans[1];
+    uint16_t open_count = 0;
+
+    /* Negative coordinates arrive as large unsigned. */
+    int16_t x0 = ux0;
+    int16_t y0 = uy0;
+
+    /* Visible part of the bitmap, in bitmap coordinates. */
+    int32_t x1 = x0 < 0 ? -x0 : 0;
+    int32_t y1 = y0 < 0 ? -y0 : 0;
+    int32_t x2 = x0 + src->width > DISPLAY_WIDTH ? DISPLAY_WIDTH - x0 : src->width;
+    int32_t y2 = y0 + src->height > DISPLAY_HEIGHT ? DISPLAY_HEIGHT - y0 : src->height;
+
+    if (x1 >= x2 || y1 >= y2) {
+        return;
+    }
+
+#ifdef HAGL_HAL_USE_QUEUE
+    /* Runs are sent directly, queued commands must go first. */
+    hagl_hal_queue_wait();
+#endif /* HAGL_HAL_USE_QUEUE */
+
+    for (uint16_t y = y1; y < y2; y++) {
+        color_t *row = (color_t *) (src->buffer + src->pitch * y);
+        uint16_t next_count = 0;
+        uint16_t i = 0;
+        uint16_t x = x1;
+
+        while (x < x2) {
+            /* Find the next opaque run. */
+            while (x < x2 && row[x] == key) {
+                x++;
+            }
+            if (x == x2) {
+                break;
+            }
+            uint16_t start = x;
+            while (x < x2 && row[x] != key) {
+                x++;
+            }
+
+            /* Rectangles left of the run cannot continue. */
+            while (i < open_count && open[i].x0 < start) {
+                hagl_hal_write_span(x0, y0, src, &open[i++]);
+            }
+
+            if (i < open_count && open[i].x0 == start && open[i].w == x - start) {
+                open[i].h++;
+                next[next_count++] = open[i++];
+            } else {
+                if (i < open_count && open[i].x0 == start) {
+                    hagl_hal_write_span(x0, y0, src, &open[i++]);
+                }
+                next[next_count++] = (hagl_hal_span_t) {start, y, x - start, 1};
+            }
+        }
+
+        while (i < open_count) {
+            hagl_hal_write_span(x0, y0, src, &open[i++]);
+        }
+
+        hagl_hal_span_t *swap = open;
+        open = next;
+        next = swap;
+        open_count = next_count;
+    }
+
+    for (uint16_t i = 0; i < open_count; i++) {
+        hagl_hal_write_span(x0, y0, src, &open[i]);
+    }
+}
+
+void hagl_hal_scale_blit(uint16_t x0, uint16_t y0, uint16_t w, uint16_t h, bitmap_t *src)
+{
+    static color_t line[DISPLAY_WIDTH];
+    int32_t previous = -1;
+    bool stream = true;
+
+    if (0 == w || 0 == h) {
+        return;
+    }
+
+    /* 16.16 fixed point steps in the source bitmap. */
+    uint32_t x_ratio = (uint32_t) ((src->width << 16) / w);
+    uint32_t y_ratio = (uint32_t) ((src->height << 16) / h);
+
+    /* HAGL does not clip scaled blits. Negative coordinates arrive as large unsigned. */
+    int32_t x1 = (int16_t) x0 < 0 ? 0 : (int16_t) x0;
+    int32_t y1 = (int16_t) y0 < 0 ? 0 : (int16_t) y0;
+    int32_t x2 = (int16_t) x0 + w > DISPLAY_WIDTH ? DISPLAY_WIDTH : (int16_t) x0 + w;
+    int32_t y2 = (int16_t) y0 + h > DISPLAY_HEIGHT ? DISPLAY_HEIGHT : (int16_t) y0 + h;
+
+    if (x1 >= x2 || y1 >= y2) {
+        return;
+    }
+
+    /* Clipped left and top parts are skipped in the source too. */
+    uint32_t ox = x1 - (int16_t) x0;
+    uint32_t oy = y1 - (int16_t) y0;
+
+    x0 = x1;
+    y0 = y1;
+    w = x2 - x1;
+    h = y2 - y1;
+
+#ifdef HAGL_HAL_USE_QUEUE
+    /* Scaled rows are sent directly, queued commands must go first. */
+    hagl_hal_queue_wait();
+#endif /* HAGL_HAL_USE_QUEUE */
+#ifdef HAGL_HAL_USE_VIEWPORTS
+    stream = !hagl_hal_viewport_hit(x0, y0, w, h);
+#endif /* HAGL_HAL_USE_VIEWPORTS */
+
+    if (stream) {
+        mipi_display_stream_begin(x0, y0, w, h);
+    }
+
+    for (uint16_t y = 0; y < h; y++) {
+        int32_t sy = ((y + oy) * y_ratio) >> 16;
+
+        /* When enlarging the same source row is often used again. */
+        if (sy != previous) {
+            color_t *row = (color_t *) (src->buffer + src->pitch * sy);
+            for (uint16_t x = 0; x < w; x++) {
+                line[x] = row[((x + ox) * x_ratio) >> 16];
+            }
+            previous = sy;
+        }
+
+        if (stream) {
+            mipi_display_stream_write((uint8_t *) line, w * sizeof(color_t));
+        } else {
+            hagl_hal_write_blit(x0, y0 + y, w, 1, line);
+        }
+    }
+
+    if (stream) {
+        mipi_display_stream_end();
+    }
+}
+
+void hagl_hal_hline(int16_t x0, int16_t y0, uint16_t width, color_t color)
+{
+#ifdef HAGL_HAL_USE_QUEUE
+    hagl_hal_command_t command = {
+        .type = HAGL_HAL_QUEUE_HLINE, .x0 = x0, .y0 = y0, .w = width, .color = color
+    };
+    hagl_hal_queue_push(&command, NULL);
+#else
+    hagl_hal_write_hline(x0, y0, width, color);
+#endif /* HAGL_HAL_USE_QUEUE */
+}
+
+void hagl_hal_vline(int16_t x0, int16_t y0, uint16_t height, color_t color)
+{
+#ifdef HAGL_HAL_USE_QUEUE
+    hagl_hal_command_t command = {
+        .type = HAGL_HAL_QUEUE_VLINE, .x0 = x0, .y0 = y0, .h = height, .color = color
+    };
+    hagl_hal_queue_push(&command, NULL);
+#else
+    hagl_hal_write_vline(x0, y0, height, color);
+#endif /* HAGL_HAL_USE_QUEUE */
+}
+
+#ifdef MIPI_DISPLAY_HAS_READ
+void hagl_hal_copy_area(int16_t x0, int16_t y0, uint16_t w, uint16_t h, int16_t x1, int16_t y1)
+{
+    static color_t line[DISPLAY_WIDTH];
+    hagl_hal_rect_t src = {.x0 = x0, .y0 = y0, .w = w, .h = h};
+    int16_t step = 1;
+    uint16_t first = 0;
+
+    if (!hagl_hal_copy_clip(&src, &x1, &y1, DISPLAY_WIDTH, DISPLAY_HEIGHT)) {
+        return;
+    }
+
+#ifdef HAGL_HAL_USE_QUEUE
+    /* Everything queued before must be in GRAM before reading it back. */
+    hagl_hal_queue_wait();
+#endif /* HAGL_HAL_USE_QUEUE */
+
+    /* Moving down, start from the bottom row. */
+    if (y1 > src.y0) {
+        step = -1;
+        first = src.h - 1;
+    }
+
+    /* Whole row is read before it is written so overlap within a row is safe. */
+    for (uint16_t i = 0, y = first; i < src.h; i++, y += step) {
+        mipi_display_read(src.x0, src.y0 + y, src.w, 1, (uint8_t *) line);
+        hagl_hal_write_blit(x1, y1 + y, src.w, 1, line);
+    }
+}
+#endif /* MIPI_DISPLAY_HAS_READ */
+
 #endif /* HAGL_HAL_USE_SINGLE_BUFFER */
@@ -0,0 +1,228 @@
+/*
+
+MIT License
+
+Copyright (c) 2021 Mika Tuupola
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+-cut-
+
+This file is part of the Kendryte K210 HAL for the HAGL graphics library:
+https://github.com/tuupola/hagl_k210_mipi
+
+SPDX-License-Identifier: MIT
+
+-cut-
+
+Sprite engine for the double buffered HAL. Sprites are drawn into the
+back buffer only for the duration of the flush. Pixels under each sprite
+are saved before drawing and restored right after the transfer. Only the
+old and new areas of sprites which changed are sent to the display.
+
+*/
+
+#include "hagl_hal.h"
+
+#ifdef HAGL_HAL_USE_SPRITES
+
+#ifndef HAGL_HAL_USE_DOUBLE_BUFFER
+#error "Sprites require HAGL_HAL_USE_DOUBLE_BUFFER."
+#endif
+
+#include <stdbool.h>
+#include <string.h>
+
+#include <bitmap.h>
+
+#include "hagl_hal_dirty.h"
+#include "hagl_hal_sprite.h"
+
+typedef struct {
+    hagl_hal_sprite_t *sprite;
+    /* What was shown on the display after previous flush. */
+    bitmap_t *bitmap;
+    hagl_hal_rect_t shown;
+    bool visible;
+    /* Where the sprite is drawn during current flush. */
+    hagl_hal_rect_t drawn;
+    color_t under[HAGL_HAL_SPRITE_MAX_WIDTH * HAGL_HAL_SPRITE_MAX_HEIGHT];
+} hagl_hal_sprite_slot_t;
+
+static hagl_hal_sprite_slot_t slots[HAGL_HAL_SPRITE_COUNT];
+/* Slot indexes sorted by z. */
+static uint8_t order[HAGL_HAL_SPRITE_COUNT];
+static uint8_t count = 0;
+
+/* Removed sprites still need their last area sent to the display. */
+static hagl_hal_rect_t removed[HAGL_HAL_SPRITE_COUNT];
+static uint8_t removed_count = 0;
+
+void hagl_hal_sprite_add(hagl_hal_sprite_t *sprite)
+{
+    if (count < HAGL_HAL_SPRITE_COUNT) {
+        memset(&slots[count], 0, sizeof(hagl_hal_sprite_slot_t) - sizeof(slots[0].under));
+        slots[count].sprite = sprite;
+        count++;
+    }
+}
+
+void hagl_hal_sprite_remove(hagl_hal_sprite_t *sprite)
+{
+    for (uint8_t i = 0; i < count; i++) {
+        if (slots[i].sprite == sprite) {
+            if (slots[i].visible && removed_count < HAGL_HAL_SPRITE_COUNT) {
+                removed[removed_count++] = slots[i].shown;
+            }
+            count--;
+            if (i != count) {
+                slots[i] = slots[count];
+            }
+            return;
+        }
+    }
+}
+
+/* Clip sprite against the back buffer. Returns false if nothing is left. */
+static bool hagl_hal_sprite_clip(hagl_hal_sprite_t *sprite, bitmap_t *bb, hagl_hal_rect_t *rect)
+{
+    int32_t x1 = sprite->x0 < 0 ? 0 : sprite->x0;
+    int32_t y1 = sprite->y0 < 0 ? 0 : sprite->y0;
+    int32_t x2 = sprite->x0 + sprite->bitmap->width;
+    int32_t y2 = sprite->y0 + sprite->bitmap->height;
+
+    if (x2 > bb->width) {
+        x2 = bb->width;
+    }
+    if (y2 > bb->height) {
+        y2 = bb->height;
+    }
+    if (x1 >= x2 || y1 >= y2) {
+        return false;
+    }
+
+    rect->x0 = x1;
+    rect->y0 = y1;
+    rect->w = x2 - x1;
+    rect->h = y2 - y1;
+
+    return true;
+}
+
+static void hagl_hal_sprite_blit(hagl_hal_sprite_t *sprite, hagl_hal_rect_t *rect, bitmap_t *bb)
+{
+    bitmap_t *bitmap = sprite->bitmap;
+    uint16_t sx = rect->x0 - sprite->x0;
+    uint16_t sy = rect->y0 - sprite->y0;
+
+    for (uint16_t y = 0; y < rect->h; y++) {
+        color_t *src = (color_t *) (bitmap->buffer + bitmap->pitch * (sy + y)) + sx;
+        color_t *dst = (color_t *) (bb->buffer + bb->pitch * (rect->y0 + y)) + rect->x0;
+
+        if (sprite->keyed) {
+            for (uint16_t x = 0; x < rect->w; x++) {
+                if (src[x] != sprite->key) {
+                    dst[x] = src[x];
+                }
+            }
+        } else {
+            memcpy(dst, src, rect->w * sizeof(color_t));
+        }
+    }
+}
+
+static void hagl_hal_sprite_copy(color_t *under, hagl_hal_rect_t *rect, bitmap_t *bb, bool save)
+{
+    for (uint16_t y = 0; y < rect->h; y++) {
+        color_t *ptr = (color_t *) (bb->buffer + bb->pitch * (rect->y0 + y)) + rect->x0;
+        if (save) {
+            memcpy(under, ptr, rect->w * sizeof(color_t));
+        } else {
+            memcpy(ptr, under, rect->w * sizeof(color_t));
+        }
+        under += rect->w;
+    }
+}
+
+void hagl_hal_sprite_draw(bitmap_t *bb, hagl_hal_dirty_t *dirty)
+{
+    for (uint8_t i = 0; i < removed_count; i++) {
+        hagl_hal_dirty_add(dirty, removed[i].x0, removed[i].y0, removed[i].w, removed[i].h);
+    }
+    removed_count = 0;
+
+    /* Insertion sort by z, there are only a handful of sprites. */
+    for (uint8_t i = 0; i < count; i++) {
+        uint8_t j = i;
+        while (j > 0 && slots[order[j - 1]].sprite->z > slots[i].sprite->z) {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = i;
+    }
+
+    for (uint8_t i = 0; i < count; i++) {
+        hagl_hal_sprite_slot_t *slot = &slots[order[i]];
+        hagl_hal_sprite_t *sprite = slot->sprite;
+        bool visible = sprite->visible
+            && sprite->bitmap->width <= HAGL_HAL_SPRITE_MAX_WIDTH
+            && sprite->bitmap->height <= HAGL_HAL_SPRITE_MAX_HEIGHT
+            && hagl_hal_sprite_clip(sprite, bb, &slot->drawn);
+
+        if (!visible) {
+            slot->drawn.w = 0;
+        } else {
+            hagl_hal_sprite_copy(slot->under, &slot->drawn, bb, true);
+            hagl_hal_sprite_blit(sprite, &slot->drawn, bb);
+        }
+
+        bool changed = visible != slot->visible
+            || sprite->bitmap != slot->bitmap
+            || slot->drawn.x0 != slot->shown.x0
+            || slot->drawn.y0 != slot->shown.y0
+            || slot->drawn.w != slot->shown.w
+            || slot->drawn.h != slot->shown.h;
+
+        if (changed) {
+            if (slot->visible) {
+                hagl_hal_dirty_add(dirty, slot->shown.x0, slot->shown.y0, slot->shown.w, slot->shown.h);
+            }
+            if (visible) {
+                hagl_hal_dirty_add(dirty, slot->drawn.x0, slot->drawn.y0, slot->drawn.w, slot->drawn.h);
+            }
+        }
+
+        slot->visible = visible;
+        slot->bitmap = sprite->bitmap;
+        slot->shown = slot->drawn;
+    }
+}
+
+void hagl_hal_sprite_restore(bitmap_t *bb)
+{
+    /* Topmost first so overlapping sprites restore correctly. */
+    for (uint8_t i = count; i > 0; i--) {
+        hagl_hal_sprite_slot_t *slot = &slots[order[i - 1]];
+        if (slot->drawn.w) {
+            hagl_hal_sprite_copy(slot->under, &slot->drawn, bb, false);
+        }
+    }
+}
+
+#endif /* HAGL_HAL_USE_SPRITES */
@@ -0,0 +1,170 @@
+/*
+
+MIT License
+
+Copyright (c) 2021 Mika Tuupola
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+-cut-
+
+This file is part of the Kendryte K210 HAL for the HAGL graphics library:
+https://github.com/tuupola/hagl_k210_mipi
+
+SPDX-License-Identifier: MIT
+
+-cut-
+
+Offscreen surfaces for the double and triple buffered HALs. Surfaces are
+allocated from a fixed size arena. New surfaces are taken from the first
+large enough free block, otherwise from the top of the arena. Freed blocks
+are kept sorted by address and merged with their neighbours so the arena
+does not fragment when widgets come and go.
+
+*/
+
+#include "hagl_hal.h"
+
+#ifdef HAGL_HAL_USE_SURFACES
+
+#if !defined(HAGL_HAL_USE_DOUBLE_BUFFER) && !defined(HAGL_HAL_USE_TRIPLE_BUFFER)
+#error "Surfaces require HAGL_HAL_USE_DOUBLE_BUFFER or HAGL_HAL_USE_TRIPLE_BUFFER."
+#endif
+#if defined(HAGL_HAL_USE_TILES) || defined(HAGL_HAL_USE_INLINE_PIXEL)
+#error "Tiles and inline pixel accessors always draw to the back buffer and cannot be used with surfaces."
+#endif
+
+#include <bitmap.h>
+
+#include "hagl_hal_surface.h"
+
+/* Block sizes are rounded up to keep pixels aligned. */
+#define HAGL_HAL_SURFACE_ALIGN(size) (((size) + 7) & ~(size_t) 7)
+
+typedef struct hagl_hal_surface {
+    /* First member so that the bitmap pointer is also the block pointer. */
+    bitmap_t bitmap;
+    /* Size of the whole block including this header. */
+    size_t size;
+    struct hagl_hal_surface *next;
+} hagl_hal_surface_t;
+
+#define HAGL_HAL_SURFACE_HEADER     HAGL_HAL_SURFACE_ALIGN(sizeof(hagl_hal_surface_t))
+
+static uint8_t arena[HAGL_HAL_SURFACE_ARENA_SIZE] __attribute__((aligned(64)));
+static size_t top = 0;
+static hagl_hal_surface_t *free_list = NULL;
+
+bitmap_t *hagl_hal_surface_alloc(uint16_t width, uint16_t height)
+{
+    size_t pixels = BITMAP_SIZE(width, height, DISPLAY_DEPTH);
+    size_t size = HAGL_HAL_SURFACE_HEADER + HAGL_HAL_SURFACE_ALIGN(pixels);
+    hagl_hal_surface_t **link = &free_list;
+    hagl_hal_surface_t *block = NULL;
+
+    if (0 == width || 0 == height) {
+        return NULL;
+    }
+
+    /* First fit from the free list. */
+    while (*link) {
+        if ((*link)->size >= size) {
+            block = *link;
+            break;
+        }
+        link = &(*link)->next;
+    }
+
+    if (block) {
+        /* Split when the rest is big enough for another surface. */
+        if (block->size - size > HAGL_HAL_SURFACE_HEADER) {
+            hagl_hal_surface_t *rest = (hagl_hal_surface_t *) ((uint8_t *) block + size);
+            rest->size = block->size - size;
+            rest->next = block->next;
+            block->size = size;
+            *link = rest;
+        } else {
+            *link = block->next;
+        }
+    } else {
+        if (size > HAGL_HAL_SURFACE_ARENA_SIZE - top) {
+            hagl_hal_debug("%s\n", "Surface arena is full.");
+            return NULL;
+        }
+        block = (hagl_hal_surface_t *) (arena + top);
+        block->size = size;
+        top += size;
+    }
+
+    block->next = NULL;
+    block->bitmap.width = width;
+    block->bitmap.height = height;
+    block->bitmap.depth = DISPLAY_DEPTH;
+    bitmap_init(&block->bitmap, (uint8_t *) block + HAGL_HAL_SURFACE_HEADER);
+
+    return &block->bitmap;
+}
+
+void hagl_hal_surface_free(bitmap_t *surface)
+{
+    hagl_hal_surface_t *block = (hagl_hal_surface_t *) surface;
+    hagl_hal_surface_t **link = &free_list;
+    hagl_hal_surface_t *prev = NULL;
+
+    if (NULL == surface) {
+        return;
+    }
+
+    /* Keep the free list sorted by address. */
+    while (*link && *link < block) {
+        prev = *link;
+        link = &(*link)->next;
+    }
+    block->next = *link;
+    *link = block;
+
+    /* Merge with the following and the preceding free block. */
+    if (block->next && (uint8_t *) block + block->size == (uint8_t *) block->next) {
+        block->size += block->next->size;
+        block->next = block->next->next;
+    }
+    if (prev && (uint8_t *) prev + prev->size == (uint8_t *) block) {
+        prev->size += block->size;
+        prev->next = block->next;
+        block = prev;
+        link = &free_list;
+        while (*link != block) {
+            link = &(*link)->next;
+        }
+    }
+
+    /* Last free block touching the top goes back to the bump area. */
+    if ((uint8_t *) block + block->size == arena + top) {
+        top -= block->size;
+        *link = NULL;
+    }
+}
+
+void hagl_hal_surface_reset(void)
+{
+    top = 0;
+    free_list = NULL;
+}
+
+#endif /* HAGL_HAL_USE_SURFACES */
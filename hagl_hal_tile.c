@@ -0,0 +1,206 @@
+/*
+
+MIT License
+
+Copyright (c) 2021 Mika Tuupola
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+-cut-
+
+This file is part of the Kendryte K210 HAL for the HAGL graphics library:
+https://github.com/tuupola/hagl_k210_mipi
+
+SPDX-License-Identifier: MIT
+
+-cut-
+
+Tiled back buffer layout for the double and triple buffered HALs. Pixels
+are stored in small tiles instead of rows, so vertical and otherwise 2D
+local drawing touches fewer cache lines. Tiles are stored row by row and
+pixels inside a tile also row by row. When flushing the tiles are turned
+back into rows through a small staging buffer.
+
+*/
+
+#include "hagl_hal.h"
+
+#ifdef HAGL_HAL_USE_TILES
+
+#if defined(HAGL_HAL_USE_DYNAMIC_BUFFER) || !defined(HAGL_HAS_HAL_BACK_BUFFER)
+#error "Tiled layout requires HAGL_HAL_USE_DOUBLE_BUFFER or HAGL_HAL_USE_TRIPLE_BUFFER."
+#endif
+#if defined(HAGL_HAL_USE_LAYERS) || defined(HAGL_HAL_USE_SPRITES) || defined(HAGL_HAL_USE_ALPHA) || defined(HAGL_HAL_USE_INLINE_PIXEL)
+#error "Layers, sprites, alpha blits and inline pixels expect row ordered back buffer."
+#endif
+
+#include <string.h>
+#include <mipi_display.h>
+
+#include <bitmap.h>
+
+#include "hagl_hal_tile.h"
+
+#if (HAGL_HAL_TILE_WIDTH & (HAGL_HAL_TILE_WIDTH - 1)) || (HAGL_HAL_TILE_HEIGHT & (HAGL_HAL_TILE_HEIGHT - 1))
+#error "HAGL_HAL_TILE_WIDTH and HAGL_HAL_TILE_HEIGHT must be powers of two."
+#endif
+#if (DISPLAY_WIDTH % HAGL_HAL_TILE_WIDTH) || (DISPLAY_HEIGHT % HAGL_HAL_TILE_HEIGHT)
+#error "Display size must be a multiple of tile size."
+#endif
+
+/* Copy a run of row ordered pixels into the tiles, one tile at a time. */
+static void hagl_hal_tile_row(bitmap_t *dst, uint16_t x0, uint16_t y0, const color_t *src, uint16_t w)
+{
+    while (w) {
+        uint16_t n = HAGL_HAL_TILE_WIDTH - x0 % HAGL_HAL_TILE_WIDTH;
+        if (n > w) {
+            n = w;
+        }
+        memcpy(hagl_hal_tile_address(dst, x0, y0), src, n * sizeof(color_t));
+        x0 += n;
+        src += n;
+        w -= n;
+    }
+}
+
+void hagl_hal_tile_hline(bitmap_t *dst, uint16_t x0, uint16_t y0, uint16_t w, color_t color)
+{
+    while (w) {
+        uint16_t n = HAGL_HAL_TILE_WIDTH - x0 % HAGL_HAL_TILE_WIDTH;
+        if (n > w) {
+            n = w;
+        }
+        color_t *ptr = hagl_hal_tile_address(dst, x0, y0);
+        for (uint16_t x = 0; x < n; x++) {
+            *ptr++ = color;
+        }
+        x0 += n;
+        w -= n;
+    }
+}
+
+void hagl_hal_tile_vline(bitmap_t *dst, uint16_t x0, uint16_t y0, uint16_t h, color_t color)
+{
+    while (h) {
+        uint16_t n = HAGL_HAL_TILE_HEIGHT - y0 % HAGL_HAL_TILE_HEIGHT;
+        if (n > h) {
+            n = h;
+        }
+        /* Inside a tile the pitch is the tile width. */
+        color_t *ptr = hagl_hal_tile_address(dst, x0, y0);
+        for (uint16_t y = 0; y < n; y++) {
+            *ptr = color;
+            ptr += HAGL_HAL_TILE_WIDTH;
+        }
+        y0 += n;
+        h -= n;
+    }
+}
+
+void hagl_hal_tile_blit(bitmap_t *dst, int16_t x0, int16_t y0, bitmap_t *src)
+{
+    /* Source can be partially outside the destination. */
+    int32_t x1 = x0 < 0 ? -x0 : 0;
+    int32_t y1 = y0 < 0 ? -y0 : 0;
+    int32_t x2 = x0 + src->width > dst->width ? dst->width - x0 : src->width;
+    int32_t y2 = y0 + src->height > dst->height ? dst->height - y0 : src->height;
+
+    if (x1 >= x2 || y1 >= y2) {
+        return;
+    }
+
+    for (int32_t y = y1; y < y2; y++) {
+        color_t *row = (color_t *) (src->buffer + src->pitch * y);
+        hagl_hal_tile_row(dst, x0 + x1, y0 + y, row + x1, x2 - x1);
+    }
+}
+
+void hagl_hal_tile_scale_blit(
+    bitmap_t *dst, int16_t x0, int16_t y0, uint16_t w, uint16_t h, bitmap_t *src
+) {
+    static color_t line[DISPLAY_WIDTH];
+
+    if (0 == w || 0 == h) {
+        return;
+    }
+
+    uint32_t x_ratio = (uint32_t) ((src->width << 16) / w);
+    uint32_t y_ratio = (uint32_t) ((src->height << 16) / h);
+
+    /* Visible part of the scaled bitmap, in scaled coordinates. */
+    int32_t x1 = x0 < 0 ? -x0 : 0;
+    int32_t y1 = y0 < 0 ? -y0 : 0;
+    int32_t x2 = x0 + w > dst->width ? dst->width - x0 : w;
+    int32_t y2 = y0 + h > dst->height ? dst->height - y0 : h;
+
+    if (x1 >= x2 || y1 >= y2) {
+        return;
+    }
+
+    for (int32_t y = y1; y < y2; y++) {
+        color_t *row = (color_t *) (src->buffer + src->pitch * ((y * y_ratio) >> 16));
+        for (int32_t x = x1; x < x2; x++) {
+            line[x - x1] = row[(x * x_ratio) >> 16];
+        }
+        hagl_hal_tile_row(dst, x0 + x1, y0 + y, line, x2 - x1);
+    }
+}
+
+size_t hagl_hal_tile_write(bitmap_t *src, uint16_t x0, uint16_t y0, uint16_t w, uint16_t h)
+{
+    static color_t lines[DISPLAY_WIDTH * HAGL_HAL_TILE_HEIGHT];
+    size_t sent = 0;
+
+    if (0 == w || 0 == h) {
+        return 0;
+    }
+
+    mipi_display_stream_begin(x0, y0, w, h);
+
+    /* One row of tiles at a time. With DMA detiling overlaps the transfer. */
+    for (uint16_t y = y0; y < y0 + h;) {
+        uint16_t rows = HAGL_HAL_TILE_HEIGHT - y % HAGL_HAL_TILE_HEIGHT;
+        if (y + rows > y0 + h) {
+            rows = y0 + h - y;
+        }
+
+        for (uint16_t row = 0; row < rows; row++) {
+            color_t *dst = lines + row * w;
+            uint16_t x = x0;
+            while (x < x0 + w) {
+                uint16_t n = HAGL_HAL_TILE_WIDTH - x % HAGL_HAL_TILE_WIDTH;
+                if (x + n > x0 + w) {
+                    n = x0 + w - x;
+                }
+                memcpy(dst, hagl_hal_tile_address(src, x, y + row), n * sizeof(color_t));
+                dst += n;
+                x += n;
+            }
+        }
+
+        sent += mipi_display_stream_write((uint8_t *) lines, rows * w * sizeof(color_t));
+        y += rows;
+    }
+
+    mipi_display_stream_end();
+
+    return sent;
+}
+
+#endif /* HAGL_HAL_USE_TILES */
@@ -0,0 +1,151 @@
+/*
+
+MIT License
+
+Copyright (c) 2021 Mika Tuupola
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+-cut-
+
+This file is part of the Kendryte K210 HAL for the HAGL graphics library:
+https://github.com/tuupola/hagl_k210_mipi
+
+SPDX-License-Identifier: MIT
+
+-cut-
+
+Timeline tracing for latency hunting. Begin and end events are stored with
+a timestamp and core id to a fixed size ring buffer. When the ring is full
+the oldest events are overwritten. The ring can be dumped as Chrome trace
+event JSON which can be opened in chrome://tracing or Perfetto.
+
+*/
+
+#include "hagl_hal.h"
+
+#ifdef HAGL_HAL_USE_TRACE
+
+#include <stdio.h>
+
+#ifdef __riscv
+#include <encoding.h>
+#include <sysctl.h>
+#else
+#include <time.h>
+#endif /* __riscv */
+
+#include "hagl_hal_trace.h"
+
+#if (HAGL_HAL_TRACE_SIZE & (HAGL_HAL_TRACE_SIZE - 1))
+#error "HAGL_HAL_TRACE_SIZE must be power of two."
+#endif
+
+typedef struct {
+    uint64_t timestamp;
+    const char *name;
+    char phase;
+    uint8_t core;
+} hagl_hal_trace_event_t;
+
+static hagl_hal_trace_event_t events[HAGL_HAL_TRACE_SIZE];
+static uint32_t head = 0;
+
+static inline uint64_t hagl_hal_trace_now(void)
+{
+#ifdef __riscv
+    return read_csr(mcycle);
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000000 + now.tv_nsec;
+#endif /* __riscv */
+}
+
+static inline uint8_t hagl_hal_trace_core(void)
+{
+#ifdef __riscv
+    return read_csr(mhartid);
+#else
+    return 0;
+#endif /* __riscv */
+}
+
+/* Timestamp ticks per microsecond. */
+static uint64_t hagl_hal_trace_ticks(void)
+{
+#ifdef __riscv
+    return sysctl_clock_get_freq(SYSCTL_CLOCK_CPU) / 1000000;
+#else
+    return 1000;
+#endif /* __riscv */
+}
+
+void hagl_hal_trace(const char *name, char phase)
+{
+    /* Reserving the slot is the only shared write. */
+    uint32_t index = __atomic_fetch_add(&head, 1, __ATOMIC_RELAXED);
+    hagl_hal_trace_event_t *event = &events[index & (HAGL_HAL_TRACE_SIZE - 1)];
+
+    event->timestamp = hagl_hal_trace_now();
+    event->name = name;
+    event->phase = phase;
+    event->core = hagl_hal_trace_core();
+}
+
+void hagl_hal_trace_clear(void)
+{
+    __atomic_store_n(&head, 0, __ATOMIC_RELEASE);
+}
+
+void hagl_hal_trace_dump(FILE *stream)
+{
+    uint32_t last = __atomic_load_n(&head, __ATOMIC_ACQUIRE);
+    uint32_t first = last > HAGL_HAL_TRACE_SIZE ? last - HAGL_HAL_TRACE_SIZE : 0;
+    uint64_t ticks = hagl_hal_trace_ticks();
+
+    fprintf(stream, "{\"traceEvents\":[\n");
+
+    for (uint32_t i = first; i < last; i++) {
+        hagl_hal_trace_event_t *event = &events[i & (HAGL_HAL_TRACE_SIZE - 1)];
+
+        fprintf(
+            stream,
+            "{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%llu.%03llu,\"pid\":0,\"tid\":%u",
+            event->name,
+            event->phase,
+            (unsigned long long) (event->timestamp / ticks),
+            (unsigned long long) (event->timestamp % ticks * 1000 / ticks),
+            event->core
+        );
+
+        if ('b' == event->phase || 'e' == event->phase) {
+            /* Async events are paired by category and id. */
+            fprintf(stream, ",\"cat\":\"%s\",\"id\":1", event->name);
+        } else if ('i' == event->phase) {
+            fprintf(stream, ",\"s\":\"g\"");
+        }
+
+        fprintf(stream, "}%s\n", i + 1 < last ? "," : "");
+    }
+
+    fprintf(stream, "],\"displayTimeUnit\":\"ms\"}\n");
+}
+
+#endif /* HAGL_HAL_USE_TRACE */
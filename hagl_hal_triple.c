@@ -53,11 +53,27 @@ valid.
 #include <bitmap.h>
 #include <hagl.h>
 
+#include "hagl_hal_alpha.h"
+#include "hagl_hal_tile.h"
+#include "hagl_hal_upscale.h"
+#include "hagl_hal_interlace.h"
+#include "hagl_hal_dirty.h"
+#include "hagl_hal_copy.h"
+
 #include <stdio.h>
 #include <stdlib.h>
 
-static uint8_t buffer1[BITMAP_SIZE(DISPLAY_WIDTH, DISPLAY_HEIGHT, DISPLAY_DEPTH)];
-static uint8_t buffer2[BITMAP_SIZE(DISPLAY_WIDTH, DISPLAY_HEIGHT, DISPLAY_DEPTH)];
+#if defined(HAGL_HAL_BUFFER_ADDRESS)
+static uint8_t *buffer1 = (uint8_t *) (HAGL_HAL_BUFFER_ADDRESS);
+static uint8_t *buffer2 = (uint8_t *) (HAGL_HAL_BUFFER_ADDRESS)
+    + BITMAP_SIZE(DISPLAY_WIDTH, DISPLAY_HEIGHT, DISPLAY_DEPTH);
+#elif defined(HAGL_HAL_USE_EXTERNAL_BUFFER)
+static uint8_t *buffer1 = NULL;
+static uint8_t *buffer2 = NULL;
+#else
+static uint8_t buffer1[BITMAP_SIZE(DISPLAY_WIDTH, DISPLAY_HEIGHT, DISPLAY_DEPTH)] HAGL_HAL_BUFFER_ATTRIBUTE;
+static uint8_t buffer2[BITMAP_SIZE(DISPLAY_WIDTH, DISPLAY_HEIGHT, DISPLAY_DEPTH)] HAGL_HAL_BUFFER_ATTRIBUTE;
+#endif
 
 static bitmap_t bb = {
     .width = DISPLAY_WIDTH,
@@ -65,11 +81,86 @@ static bitmap_t bb = {
     .depth = DISPLAY_DEPTH,
 };
 
+/* Bitmap the drawing primitives currently write to. */
+static bitmap_t *target = &bb;
+
+/* Buffer flushed last, NULL before the first flush. */
+static uint8_t *shown = NULL;
+
+#ifdef HAGL_HAL_USE_EXTERNAL_BUFFER
+void hagl_hal_set_buffers(uint8_t *memory1, uint8_t *memory2)
+{
+    buffer1 = memory1;
+    buffer2 = memory2;
+}
+#endif /* HAGL_HAL_USE_EXTERNAL_BUFFER */
+
+#ifdef HAGL_HAL_USE_INLINE_PIXEL
+color_t *hagl_hal_buffer = NULL;
+#endif /* HAGL_HAL_USE_INLINE_PIXEL */
+
+#ifdef HAGL_HAL_USE_BUFFER_AGE
+/* Frames of damage kept, enough for two back buffers. */
+#define HAGL_HAL_DAMAGE_HISTORY     (2)
+
+static uint32_t frames = 0;
+/* Frame number when each back buffer was last flushed, 0 if never. */
+static uint32_t presented[2] = {0, 0};
+static hagl_hal_dirty_t damage;
+static hagl_hal_dirty_t history[HAGL_HAL_DAMAGE_HISTORY];
+
+void hagl_hal_add_damage(int16_t x0, int16_t y0, uint16_t w, uint16_t h)
+{
+    hagl_hal_dirty_add(&damage, x0, y0, w, h);
+}
+
+uint8_t hagl_hal_buffer_age(void)
+{
+    uint32_t when = presented[bb.buffer == buffer1 ? 0 : 1];
+
+    if (0 == when || frames - when + 1 > 255) {
+        return 0;
+    }
+    return frames - when + 1;
+}
+
+void hagl_hal_buffer_damage(hagl_hal_dirty_t *out)
+{
+    uint8_t age = hagl_hal_buffer_age();
+
+    hagl_hal_dirty_clear(out);
+
+    if (0 == age || age - 1 > HAGL_HAL_DAMAGE_HISTORY) {
+        hagl_hal_dirty_add(out, 0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT);
+        return;
+    }
+
+    /* Union of the frames drawn to the other buffer meanwhile. */
+    for (uint8_t i = 0; i < age - 1; i++) {
+        hagl_hal_dirty_t *frame = &history[(frames - i) % HAGL_HAL_DAMAGE_HISTORY];
+        for (uint8_t j = 0; j < frame->count; j++) {
+            hagl_hal_rect_t *rect = &frame->rects[j];
+            hagl_hal_dirty_add(out, rect->x0, rect->y0, rect->w, rect->h);
+        }
+    }
+}
+#endif /* HAGL_HAL_USE_BUFFER_AGE */
+
 bitmap_t *hagl_hal_init(void)
 {
+#ifdef HAGL_HAL_USE_EXTERNAL_BUFFER
+    if (NULL == buffer1 || NULL == buffer2) {
+        hagl_hal_debug("%s\n", "Back buffers have not been set.");
+        return NULL;
+    }
+#endif /* HAGL_HAL_USE_EXTERNAL_BUFFER */
+
     mipi_display_init();
     bitmap_init(&bb, buffer2);
     bitmap_init(&bb, buffer1);
+#ifdef HAGL_HAL_USE_INLINE_PIXEL
+    hagl_hal_buffer = (color_t *) bb.buffer;
+#endif /* HAGL_HAL_USE_INLINE_PIXEL */
 
     hagl_hal_debug("Back buffer 1 address is %p\n", (void *) buffer1);
     hagl_hal_debug("Back buffer 2 address is %p\n", (void *) buffer2);
@@ -80,51 +171,181 @@ bitmap_t *hagl_hal_init(void)
 size_t hagl_hal_flush()
 {
     uint8_t *buffer = bb.buffer;
+    size_t sent;
+
+    HAGL_HAL_TRACE_BEGIN("hagl_hal_flush");
+#ifdef HAGL_HAL_USE_BUFFER_AGE
+    /* Damage of this frame goes to history. */
+    frames++;
+    presented[bb.buffer == buffer1 ? 0 : 1] = frames;
+    history[frames % HAGL_HAL_DAMAGE_HISTORY] = damage;
+    hagl_hal_dirty_clear(&damage);
+#endif /* HAGL_HAL_USE_BUFFER_AGE */
     if (bb.buffer == buffer1) {
         bb.buffer = buffer2;
     } else {
         bb.buffer = buffer1;
     }
+    shown = buffer;
+#ifdef HAGL_HAL_USE_INLINE_PIXEL
+    hagl_hal_buffer = (color_t *) bb.buffer;
+#endif /* HAGL_HAL_USE_INLINE_PIXEL */
     /* Flush the current back buffer. */
-    return mipi_display_write(0, 0, bb.width, bb.height, (uint8_t *) buffer);
+#if defined(HAGL_HAL_USE_TILES)
+    bitmap_t front = bb;
+    front.buffer = buffer;
+    sent = hagl_hal_tile_write(&front, 0, 0, bb.width, bb.height);
+#elif HAGL_HAL_UPSCALE > 1
+    bitmap_t front = bb;
+    front.buffer = buffer;
+    sent = hagl_hal_upscale_write(&front, 0, 0, bb.width, bb.height);
+#elif defined(HAGL_HAL_USE_INTERLACE)
+    bitmap_t front = bb;
+    front.buffer = buffer;
+    sent = hagl_hal_interlace_flush(&front);
+#else
+    sent = mipi_display_write(0, 0, bb.width, bb.height, (uint8_t *) buffer);
+#endif /* HAGL_HAL_USE_TILES */
+    HAGL_HAL_TRACE_END("hagl_hal_flush");
+
+    return sent;
+}
+
+size_t hagl_hal_flush_rect(int16_t x0, int16_t y0, uint16_t w, uint16_t h)
+{
+#if defined(HAGL_HAL_USE_TILES)
+    return hagl_hal_tile_write(&bb, x0, y0, w, h);
+#elif HAGL_HAL_UPSCALE > 1
+    return hagl_hal_upscale_write(&bb, x0, y0, w, h);
+#else
+    uint8_t *ptr = bb.buffer + bb.pitch * y0 + (bb.depth / 8) * x0;
+    return mipi_display_write_pitch(x0, y0, w, h, bb.pitch, ptr);
+#endif /* HAGL_HAL_USE_TILES */
+}
+
+#ifdef HAGL_HAL_USE_SURFACES
+void hagl_hal_set_target(bitmap_t *bitmap)
+{
+    if (NULL == bitmap) {
+        target = &bb;
+    } else {
+        target = bitmap;
+    }
+    /* Primitives are not clipped by the HAL so let HAGL do it. */
+    hagl_set_clip_window(0, 0, target->width - 1, target->height - 1);
+}
+#endif /* HAGL_HAL_USE_SURFACES */
+
+void hagl_hal_copy_area(int16_t x0, int16_t y0, uint16_t w, uint16_t h, int16_t x1, int16_t y1)
+{
+    hagl_hal_rect_t src = {.x0 = x0, .y0 = y0, .w = w, .h = h};
+    bitmap_t from = *target;
+
+    if (!hagl_hal_copy_clip(&src, &x1, &y1, target->width, target->height)) {
+        return;
+    }
+
+    /* Back buffer holds an older frame, copy what is on the display. */
+    if (target == &bb && NULL != shown) {
+        from.buffer = shown;
+    }
+    hagl_hal_copy_bitmap(target, &from, &src, x1, y1);
+
+#ifdef HAGL_HAL_USE_BUFFER_AGE
+    /* Only the destination changed. */
+    if (target == &bb) {
+        hagl_hal_dirty_add(&damage, x1, y1, src.w, src.h);
+    }
+#endif /* HAGL_HAL_USE_BUFFER_AGE */
 }
 
+#ifndef HAGL_HAL_USE_INLINE_PIXEL
 void hagl_hal_put_pixel(int16_t x0, int16_t y0, color_t color)
 {
-    color_t *ptr = (color_t *) (bb.buffer + bb.pitch * y0 + (bb.depth / 8) * x0);
+#ifdef HAGL_HAL_USE_TILES
+    *hagl_hal_tile_address(target, x0, y0) = color;
+#else
+    color_t *ptr = (color_t *) (target->buffer + target->pitch * y0 + (target->depth / 8) * x0);
     *ptr = color;
+#endif /* HAGL_HAL_USE_TILES */
 }
+#endif /* HAGL_HAL_USE_INLINE_PIXEL */
 
+void hagl_hal_put_pixels(const point_t *points, const color_t *colors, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        int16_t x0 = points[i].x;
+        int16_t y0 = points[i].y;
+        if (x0 < 0 || y0 < 0 || x0 >= target->width || y0 >= target->height) {
+            continue;
+        }
+#ifdef HAGL_HAL_USE_TILES
+        *hagl_hal_tile_address(target, x0, y0) = colors[i];
+#else
+        ((color_t *) (target->buffer + target->pitch * y0))[x0] = colors[i];
+#endif /* HAGL_HAL_USE_TILES */
+    }
+}
+
+#ifndef HAGL_HAL_USE_INLINE_PIXEL
 color_t hagl_hal_get_pixel(int16_t x0, int16_t y0)
 {
-    return *(color_t *) (bb.buffer + bb.pitch * y0 + (bb.depth / 8) * x0);
+#ifdef HAGL_HAL_USE_TILES
+    return *hagl_hal_tile_address(target, x0, y0);
+#else
+    return *(color_t *) (target->buffer + target->pitch * y0 + (target->depth / 8) * x0);
+#endif /* HAGL_HAL_USE_TILES */
 }
+#endif /* HAGL_HAL_USE_INLINE_PIXEL */
 
 void hagl_hal_blit(uint16_t x0, uint16_t y0, bitmap_t *src)
 {
-    bitmap_blit(x0, y0, src, &bb);
+#ifdef HAGL_HAL_USE_TILES
+    hagl_hal_tile_blit(target, x0, y0, src);
+#else
+    bitmap_blit(x0, y0, src, target);
+#endif /* HAGL_HAL_USE_TILES */
+}
+
+#ifdef HAGL_HAL_USE_ALPHA
+void hagl_hal_alpha_blit(int16_t x0, int16_t y0, bitmap_t *src, const uint8_t *alpha, uint8_t bits)
+{
+    hagl_hal_alpha_blend(target, x0, y0, src, alpha, bits);
 }
+#endif /* HAGL_HAL_USE_ALPHA */
 
 void hagl_hal_scale_blit(uint16_t x0, uint16_t y0, uint16_t w, uint16_t h, bitmap_t *src)
 {
-    bitmap_scale_blit(x0, y0, w, h, src, &bb);
+#ifdef HAGL_HAL_USE_TILES
+    hagl_hal_tile_scale_blit(target, x0, y0, w, h, src);
+#else
+    bitmap_scale_blit(x0, y0, w, h, src, target);
+#endif /* HAGL_HAL_USE_TILES */
 }
 
 void hagl_hal_hline(int16_t x0, int16_t y0, uint16_t width, color_t color)
 {
-    color_t *ptr = (color_t *) (bb.buffer + bb.pitch * y0 + (bb.depth / 8) * x0);
+#ifdef HAGL_HAL_USE_TILES
+    hagl_hal_tile_hline(target, x0, y0, width, color);
+#else
+    color_t *ptr = (color_t *) (target->buffer + target->pitch * y0 + (target->depth / 8) * x0);
     for (uint16_t x = 0; x < width; x++) {
         *ptr++ = color;
     }
+#endif /* HAGL_HAL_USE_TILES */
 }
 
 void hagl_hal_vline(int16_t x0, int16_t y0, uint16_t height, color_t color)
 {
-    color_t *ptr = (color_t *) (bb.buffer + bb.pitch * y0 + (bb.depth / 8) * x0);
+#ifdef HAGL_HAL_USE_TILES
+    hagl_hal_tile_vline(target, x0, y0, height, color);
+#else
+    color_t *ptr = (color_t *) (target->buffer + target->pitch * y0 + (target->depth / 8) * x0);
     for (uint16_t y = 0; y < height; y++) {
         *ptr = color;
-        ptr += bb.pitch / (bb.depth / 8);
+        ptr += target->pitch / (target->depth / 8);
     }
+#endif /* HAGL_HAL_USE_TILES */
 }
 
 #endif /* HAGL_HAL_USE_TRIPLE_BUFFER */
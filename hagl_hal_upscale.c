@@ -0,0 +1,98 @@
+/*
+
+MIT License
+
+Copyright (c) 2021 Mika Tuupola
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+-cut-
+
+This file is part of the Kendryte K210 HAL for the HAGL graphics library:
+https://github.com/tuupola/hagl_k210_mipi
+
+SPDX-License-Identifier: MIT
+
+-cut-
+
+Low resolution back buffer for the double and triple buffered HALs. The
+back buffer is HAGL_HAL_UPSCALE times smaller in both directions. When
+flushing each row is widened to a line buffer which is then sent as many
+times as needed. With DMA the next row is widened while the previous one
+is being sent.
+
+*/
+
+#include "hagl_hal.h"
+
+#if HAGL_HAL_UPSCALE > 1
+
+#if defined(HAGL_HAL_USE_DYNAMIC_BUFFER) || !defined(HAGL_HAS_HAL_BACK_BUFFER)
+#error "Upscaling requires HAGL_HAL_USE_DOUBLE_BUFFER or HAGL_HAL_USE_TRIPLE_BUFFER."
+#endif
+#if defined(HAGL_HAL_USE_LAYERS) || defined(HAGL_HAL_USE_TILES)
+#error "Layers and tiles have their own flush and cannot be upscaled."
+#endif
+#if (MIPI_DISPLAY_WIDTH % HAGL_HAL_UPSCALE) || (MIPI_DISPLAY_HEIGHT % HAGL_HAL_UPSCALE)
+#error "Display size must be a multiple of HAGL_HAL_UPSCALE."
+#endif
+
+#include <mipi_display.h>
+
+#include <bitmap.h>
+
+#include "hagl_hal_upscale.h"
+
+size_t hagl_hal_upscale_write(bitmap_t *src, uint16_t x0, uint16_t y0, uint16_t w, uint16_t h)
+{
+    static color_t line[MIPI_DISPLAY_WIDTH];
+    size_t size = w * HAGL_HAL_UPSCALE * sizeof(color_t);
+    size_t sent = 0;
+
+    if (0 == w || 0 == h) {
+        return 0;
+    }
+
+    mipi_display_stream_begin(
+        x0 * HAGL_HAL_UPSCALE, y0 * HAGL_HAL_UPSCALE,
+        w * HAGL_HAL_UPSCALE, h * HAGL_HAL_UPSCALE
+    );
+
+    for (uint16_t y = y0; y < y0 + h; y++) {
+        color_t *row = (color_t *) (src->buffer + src->pitch * y) + x0;
+        color_t *dst = line;
+
+        for (uint16_t x = 0; x < w; x++) {
+            for (uint8_t i = 0; i < HAGL_HAL_UPSCALE; i++) {
+                *dst++ = row[x];
+            }
+        }
+
+        /* Line is copied to the DMA staging buffer, same line can be sent again. */
+        for (uint8_t i = 0; i < HAGL_HAL_UPSCALE; i++) {
+            sent += mipi_display_stream_write((uint8_t *) line, size);
+        }
+    }
+
+    mipi_display_stream_end();
+
+    return sent;
+}
+
+#endif /* HAGL_HAL_UPSCALE > 1 */
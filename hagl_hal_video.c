@@ -0,0 +1,261 @@
+/*
+
+MIT License
+
+Copyright (c) 2021 Mika Tuupola
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+-cut-
+
+This file is part of the Kendryte K210 HAL for the HAGL graphics library:
+https://github.com/tuupola/hagl_k210_mipi
+
+SPDX-License-Identifier: MIT
+
+-cut-
+
+Playback of raw RGB565 video. Frames are read in strips of rows to two
+buffers. While one strip is being sent to the display the next one is
+being read. For real overlap register hagl_hal_video_core1() to the second
+core, otherwise strips are sent from the same core in between reads.
+
+*/
+
+#include "hagl_hal.h"
+
+#ifdef HAGL_HAL_USE_VIDEO
+
+#include <stdbool.h>
+#include <string.h>
+#include <mipi_display.h>
+
+#ifndef __riscv
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif /* __riscv */
+
+#include "hagl_hal_video.h"
+
+typedef struct {
+    uint8_t *buffer;
+    int16_t y;
+    uint16_t rows;
+} hagl_hal_strip_t;
+
+/*
+Single producer single consumer handoff of the two strips. Head is written
+only by the reader and tail only by the presenter.
+*/
+static hagl_hal_strip_t strips[2];
+static uint32_t head = 0;
+static uint32_t tail = 0;
+static hagl_hal_video_t *playing = NULL;
+static bool presenter = false;
+
+static void hagl_hal_video_present(hagl_hal_video_t *video, hagl_hal_strip_t *strip)
+{
+    mipi_display_write(
+        video->x0, video->y0 + strip->y, video->width, strip->rows, strip->buffer
+    );
+}
+
+int hagl_hal_video_core1(void *ctx)
+{
+    (void) ctx;
+
+    __atomic_store_n(&presenter, true, __ATOMIC_RELEASE);
+
+    while (1) {
+        uint32_t current = tail;
+        if (current != __atomic_load_n(&head, __ATOMIC_ACQUIRE)) {
+            hagl_hal_video_present(playing, &strips[current & 1]);
+            __atomic_store_n(&tail, current + 1, __ATOMIC_RELEASE);
+        }
+    }
+
+    return 0;
+}
+
+/* Returns a free strip buffer. */
+static hagl_hal_strip_t *hagl_hal_video_acquire(hagl_hal_video_t *video)
+{
+    /* Wait until the presenter is done with the older strip. */
+    while (head - __atomic_load_n(&tail, __ATOMIC_ACQUIRE) == 2) {
+    }
+
+    hagl_hal_strip_t *strip = &strips[head & 1];
+    strip->buffer = video->buffers[head & 1];
+    return strip;
+}
+
+static void hagl_hal_video_release(hagl_hal_video_t *video, hagl_hal_strip_t *strip)
+{
+    if (__atomic_load_n(&presenter, __ATOMIC_ACQUIRE)) {
+        __atomic_store_n(&head, head + 1, __ATOMIC_RELEASE);
+    } else {
+        /* No second core, send right away. */
+        hagl_hal_video_present(video, strip);
+    }
+}
+
+/* Read rows y ... y + rows - 1 in strips. Returns false at the end of the video. */
+static bool hagl_hal_video_rows(hagl_hal_video_t *video, int16_t y, uint16_t rows)
+{
+    size_t pitch = video->width * sizeof(color_t);
+    uint16_t max = video->size / pitch;
+
+    while (rows) {
+        hagl_hal_strip_t *strip = hagl_hal_video_acquire(video);
+        strip->y = y;
+        strip->rows = rows < max ? rows : max;
+
+        size_t size = strip->rows * pitch;
+        if (video->read(strip->buffer, size, video->ctx) < size) {
+            return false;
+        }
+        hagl_hal_video_release(video, strip);
+
+        y += strip->rows;
+        rows -= strip->rows;
+    }
+
+    return true;
+}
+
+static bool hagl_hal_video_frame(hagl_hal_video_t *video)
+{
+    static uint8_t mask[(DISPLAY_HEIGHT + 7) / 8];
+    size_t size = (video->height + 7) / 8;
+
+    if (!video->delta) {
+        return hagl_hal_video_rows(video, 0, video->height);
+    }
+
+    if (video->read(mask, size, video->ctx) < size) {
+        return false;
+    }
+
+    /* Consecutive changed rows are read and sent together. */
+    for (int16_t y = 0; y < video->height;) {
+        uint16_t rows = 0;
+        while (y + rows < video->height && (mask[(y + rows) >> 3] & (0x80 >> ((y + rows) & 7)))) {
+            rows++;
+        }
+        if (rows) {
+            if (!hagl_hal_video_rows(video, y, rows)) {
+                return false;
+            }
+            y += rows;
+        } else {
+            y++;
+        }
+    }
+
+    return true;
+}
+
+uint32_t hagl_hal_video_play(hagl_hal_video_t *video)
+{
+    uint32_t frames = 0;
+
+    if (video->size < video->width * sizeof(color_t)) {
+        return 0;
+    }
+
+    /* Strips are sent as is, the video must fit on the display. */
+    if (video->x0 < 0 || video->y0 < 0 ||
+        video->x0 + video->width > DISPLAY_WIDTH ||
+        video->y0 + video->height > DISPLAY_HEIGHT) {
+        return 0;
+    }
+
+    playing = video;
+
+    while (hagl_hal_video_frame(video)) {
+        frames++;
+    }
+
+    /* Wait until the presenter has sent everything. */
+    while (__atomic_load_n(&tail, __ATOMIC_ACQUIRE) != head) {
+    }
+
+    return frames;
+}
+
+#ifndef __riscv
+typedef struct {
+    uint8_t *data;
+    size_t size;
+    size_t offset;
+} hagl_hal_video_file_t;
+
+static hagl_hal_video_file_t file;
+
+static size_t hagl_hal_video_mmap_read(uint8_t *buffer, size_t size, void *ctx)
+{
+    hagl_hal_video_file_t *file = ctx;
+
+    if (size > file->size - file->offset) {
+        size = file->size - file->offset;
+    }
+    memcpy(buffer, file->data + file->offset, size);
+    file->offset += size;
+
+    return size;
+}
+
+int8_t hagl_hal_video_mmap(hagl_hal_video_t *video, const char *path)
+{
+    struct stat st;
+    int fd = open(path, O_RDONLY);
+
+    if (fd < 0) {
+        return -1;
+    }
+    if (fstat(fd, &st) < 0 || 0 == st.st_size) {
+        close(fd);
+        return -1;
+    }
+
+    file.data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (MAP_FAILED == file.data) {
+        return -1;
+    }
+    file.size = st.st_size;
+    file.offset = 0;
+
+    video->read = hagl_hal_video_mmap_read;
+    video->ctx = &file;
+
+    return 0;
+}
+
+void hagl_hal_video_munmap(hagl_hal_video_t *video)
+{
+    munmap(file.data, file.size);
+    video->read = NULL;
+    video->ctx = NULL;
+}
+#endif /* __riscv */
+
+#endif /* HAGL_HAL_USE_VIDEO */
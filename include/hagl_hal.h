@@ -42,10 +42,22 @@ extern "C" {
 
 typedef uint16_t color_t;
 
+typedef struct {
+    int16_t x;
+    int16_t y;
+} point_t;
+
 #define hagl_hal_debug(fmt, ...) \
     do { if (HAGL_HAL_DEBUG) printf("[HAGL HAL] " fmt, __VA_ARGS__); } while (0)
 
-#if defined(HAGL_HAL_USE_TRIPLE_BUFFER)
+/* Sprites send only the areas which changed. */
+#if defined(HAGL_HAL_USE_SPRITES) && !defined(HAGL_HAL_USE_DIRTY)
+#define HAGL_HAL_USE_DIRTY
+#endif
+
+#if defined(HAGL_HAL_USE_DYNAMIC_BUFFER)
+#include "hagl_hal_dynamic.h"
+#elif defined(HAGL_HAL_USE_TRIPLE_BUFFER)
 #include "hagl_hal_triple.h"
 #elif defined(HAGL_HAL_USE_DOUBLE_BUFFER)
 #include "hagl_hal_double.h"
@@ -53,6 +65,8 @@ typedef uint16_t color_t;
 #include "hagl_hal_single.h"
 #endif /* HAGL_HAL_USE_TRIPLE_BUFFER */
 
+#include "hagl_hal_trace.h"
+
 #define MIPI_DISPLAY_GPIO_DC        (2)
 #define MIPI_DISPLAY_GPIO_RST       (3)
 
@@ -63,6 +77,13 @@ typedef uint16_t color_t;
 #ifndef MIPI_DISPLAY_SPI_CLOCK_SPEED_HZ
 #define MIPI_DISPLAY_SPI_CLOCK_SPEED_HZ     (65 * 1000 * 1000)
 #endif
+/* Bytes converted and sent at once. Must be a multiple of pixel size. */
+#ifndef MIPI_DISPLAY_CHUNK_SIZE
+#define MIPI_DISPLAY_CHUNK_SIZE     (2048)
+#endif
+#ifndef MIPI_DISPLAY_DMA_CHANNEL
+#define MIPI_DISPLAY_DMA_CHANNEL    (DMAC_CHANNEL0)
+#endif
 #ifndef MIPI_DISPLAY_PIN_CS
 #define MIPI_DISPLAY_PIN_CS         (36)
 #endif
@@ -107,10 +128,53 @@ typedef uint16_t color_t;
 #define MIPI_DISPLAY_OFFSET_Y       (0)
 #endif
 
-#define DISPLAY_WIDTH               (MIPI_DISPLAY_WIDTH)
-#define DISPLAY_HEIGHT              (MIPI_DISPLAY_HEIGHT)
+/* Start of the 2MB AI SRAM bank. Free for buffers when KPU is not used. */
+#define HAGL_HAL_AI_SRAM_ADDRESS    (0x80600000)
+
+/* Back buffers are cache line aligned and optionally in given section. */
+#ifdef HAGL_HAL_BUFFER_SECTION
+#define HAGL_HAL_BUFFER_ATTRIBUTE   __attribute__((section(HAGL_HAL_BUFFER_SECTION), aligned(64)))
+#else
+#define HAGL_HAL_BUFFER_ATTRIBUTE   __attribute__((aligned(64)))
+#endif /* HAGL_HAL_BUFFER_SECTION */
+
+/* Render at lower resolution, back buffer is upscaled when flushing. */
+#ifndef HAGL_HAL_UPSCALE
+#define HAGL_HAL_UPSCALE            (1)
+#endif
+
+#define DISPLAY_WIDTH               (MIPI_DISPLAY_WIDTH / HAGL_HAL_UPSCALE)
+#define DISPLAY_HEIGHT              (MIPI_DISPLAY_HEIGHT / HAGL_HAL_UPSCALE)
 #define DISPLAY_DEPTH               (MIPI_DISPLAY_DEPTH)
 
+#ifdef HAGL_HAL_USE_INLINE_PIXEL
+#if defined(HAGL_HAL_USE_DYNAMIC_BUFFER) || !defined(HAGL_HAS_HAL_BACK_BUFFER)
+#error "Inline pixel accessors require HAGL_HAL_USE_DOUBLE_BUFFER or HAGL_HAL_USE_TRIPLE_BUFFER."
+#endif
+#ifdef HAGL_HAL_USE_LAYERS
+#error "Inline pixel accessors always draw to the back buffer and cannot be used with HAGL_HAL_USE_LAYERS."
+#endif
+#if (DISPLAY_DEPTH != 16)
+#error "Inline pixel accessors require 16 bit color depth."
+#endif
+
+/*
+Current back buffer. Pitch and depth are known at compile time so these
+replace the out of line versions. HAGL and the application both call them.
+*/
+extern color_t *hagl_hal_buffer;
+
+static inline void hagl_hal_put_pixel(int16_t x0, int16_t y0, color_t color)
+{
+    hagl_hal_buffer[y0 * DISPLAY_WIDTH + x0] = color;
+}
+
+static inline color_t hagl_hal_get_pixel(int16_t x0, int16_t y0)
+{
+    return hagl_hal_buffer[y0 * DISPLAY_WIDTH + x0];
+}
+#endif /* HAGL_HAL_USE_INLINE_PIXEL */
+
 #ifdef __cplusplus
 }
 #endif
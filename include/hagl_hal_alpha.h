@@ -0,0 +1,88 @@
+/*
+
+MIT License
+
+Copyright (c) 2021 Mika Tuupola
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+-cut-
+
+This file is part of the Kendryte K210 HAL for the HAGL graphics library:
+https://github.com/tuupola/hagl_k210_mipi
+
+SPDX-License-Identifier: MIT
+
+-cut-
+
+Alpha blended blits for the buffered HALs. Source bitmap has a separate
+8 or 4 bit alpha plane. Pixels are blended in SWAR fashion, green, red and
+blue are spread apart so they can be blended with one multiply. Two pixels
+with same alpha are blended at once in a 64 bit register. Runs of fully
+transparent pixels are skipped and runs of opaque pixels copied.
+
+*/
+
+#ifndef _HAGL_HAL_ALPHA_H
+#define _HAGL_HAL_ALPHA_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <bitmap.h>
+
+#include "hagl_hal.h"
+
+/**
+ * Blend bitmap with alpha plane to another bitmap
+ *
+ * With 8 bit alpha the plane has one byte per pixel. With 4 bit alpha
+ * there are two pixels per byte, high nibble first, rows padded to full
+ * bytes. Source is clipped to the destination.
+ *
+ * @param dst Pointer to the destination bitmap
+ * @param x0 X coordinate
+ * @param y0 Y coorginate
+ * @param src Pointer to the source bitmap
+ * @param alpha Pointer to the alpha plane
+ * @param bits 8 or 4
+ */
+void hagl_hal_alpha_blend(
+    bitmap_t *dst, int16_t x0, int16_t y0, bitmap_t *src, const uint8_t *alpha, uint8_t bits
+);
+
+/**
+ * Blend bitmap with alpha plane to the back buffer
+ *
+ * Does nothing in single buffered mode.
+ *
+ * @param x0 X coordinate
+ * @param y0 Y coorginate
+ * @param src Pointer to the source bitmap
+ * @param alpha Pointer to the alpha plane
+ * @param bits 8 or 4
+ */
+void hagl_hal_alpha_blit(int16_t x0, int16_t y0, bitmap_t *src, const uint8_t *alpha, uint8_t bits);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* _HAGL_HAL_ALPHA_H */
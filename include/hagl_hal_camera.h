@@ -0,0 +1,93 @@
+/*
+
+MIT License
+
+Copyright (c) 2021 Mika Tuupola
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+-cut-
+
+This file is part of the Kendryte K210 HAL for the HAGL graphics library:
+https://github.com/tuupola/hagl_k210_mipi
+
+SPDX-License-Identifier: MIT
+
+-cut-
+
+Camera passthrough for the K210 DVP. Camera frames are sent to the display
+straight from the memory DVP writes them to. An optional overlay region is
+taken from a HAGL bitmap, usually the back buffer, and merged row by row
+into the outgoing transfer. The camera frame is never copied or modified.
+
+*/
+
+#ifndef _HAGL_HAL_CAMERA_H
+#define _HAGL_HAL_CAMERA_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <bitmap.h>
+
+#include "hagl_hal.h"
+
+/**
+ * Set the overlay region
+ *
+ * Region is given in display coordinates and is taken from the same
+ * coordinates of the source bitmap. When keyed pixels with the key color
+ * are transparent. Pass NULL as source to disable the overlay.
+ *
+ * @param source Pointer to the overlay bitmap, usually the back buffer
+ * @param x0 X coordinate
+ * @param y0 Y coorginate
+ * @param w width of the region
+ * @param h height of the region
+ * @param keyed use color key transparency
+ * @param key RGB565 color which is transparent
+ */
+void hagl_hal_camera_set_overlay(
+    bitmap_t *source, int16_t x0, int16_t y0, uint16_t w, uint16_t h,
+    uint8_t keyed, color_t key
+);
+
+/**
+ * Send a camera frame to the display
+ *
+ * Frame must be RGB565 in the same byte order as the display expects.
+ * Frame is clipped to the display.
+ * Rows which are not covered by the overlay are sent directly from the
+ * frame. With opaque overlay the covered rows are sent in three parts
+ * so nothing is copied at all.
+ *
+ * @param x0 X coordinate
+ * @param y0 Y coorginate
+ * @param frame Pointer to the camera frame
+ * @return number of bytes sent
+ */
+size_t hagl_hal_camera_write(uint16_t x0, uint16_t y0, bitmap_t *frame);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* _HAGL_HAL_CAMERA_H */
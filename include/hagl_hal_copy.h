@@ -0,0 +1,87 @@
+/*
+
+MIT License
+
+Copyright (c) 2021 Mika Tuupola
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+-cut-
+
+This file is part of the Kendryte K210 HAL for the HAGL graphics library:
+https://github.com/tuupola/hagl_k210_mipi
+
+SPDX-License-Identifier: MIT
+
+-cut-
+
+Moving pixels inside a bitmap. Used by hagl_hal_copy_area() of the back
+buffer HALs for scrolling and moving windows without redrawing them.
+
+*/
+
+#ifndef _HAGL_HAL_COPY_H
+#define _HAGL_HAL_COPY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <bitmap.h>
+
+#include "hagl_hal.h"
+#include "hagl_hal_dirty.h"
+
+/**
+ * Clip a copy to the given size
+ *
+ * Source is clipped and destination is moved by the same amount.
+ *
+ * @param src Pointer to the source area
+ * @param x1 Pointer to the destination X coordinate
+ * @param y1 Pointer to the destination Y coorginate
+ * @param width width of the bitmap
+ * @param height height of the bitmap
+ * @return false if nothing is left to copy
+ */
+bool hagl_hal_copy_clip(hagl_hal_rect_t *src, int16_t *x1, int16_t *y1, uint16_t width, uint16_t height);
+
+/**
+ * Copy an area from one bitmap to another or inside the same bitmap
+ *
+ * Bitmaps must have the same size and layout. Source and destination may
+ * overlap when copying inside the same bitmap. Both must be inside the
+ * bitmaps.
+ *
+ * @param bitmap Pointer to the destination bitmap
+ * @param from Pointer to the source bitmap
+ * @param src Pointer to the source area
+ * @param x1 Destination X coordinate
+ * @param y1 Destination Y coorginate
+ */
+void hagl_hal_copy_bitmap(
+    bitmap_t *bitmap, const bitmap_t *from, const hagl_hal_rect_t *src, int16_t x1, int16_t y1
+);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* _HAGL_HAL_COPY_H */
@@ -0,0 +1,93 @@
+/*
+
+MIT License
+
+Copyright (c) 2021 Mika Tuupola
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+-cut-
+
+This file is part of the Kendryte K210 HAL for the HAGL graphics library:
+https://github.com/tuupola/hagl_k210_mipi
+
+SPDX-License-Identifier: MIT
+
+-cut-
+
+Dirty rectangle bookkeeping for the back buffer HALs. Areas which need
+to be sent to the display are collected into a small fixed size list.
+Overlapping areas are merged. When the list is full the new area is
+merged to the rectangle which grows the least.
+
+*/
+
+#ifndef _HAGL_HAL_DIRTY_H
+#define _HAGL_HAL_DIRTY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#include "hagl_hal.h"
+
+/* Maximum number of separate dirty rectangles. */
+#ifndef HAGL_HAL_DIRTY_COUNT
+#define HAGL_HAL_DIRTY_COUNT        (16)
+#endif
+
+typedef struct {
+    int16_t x0;
+    int16_t y0;
+    uint16_t w;
+    uint16_t h;
+} hagl_hal_rect_t;
+
+typedef struct {
+    uint8_t count;
+    hagl_hal_rect_t rects[HAGL_HAL_DIRTY_COUNT];
+} hagl_hal_dirty_t;
+
+/**
+ * Remove all rectangles
+ *
+ * @param dirty Pointer to the dirty list
+ */
+void hagl_hal_dirty_clear(hagl_hal_dirty_t *dirty);
+
+/**
+ * Add a rectangle
+ *
+ * Rectangle is clipped to the display. Rectangles keep the order they
+ * were added in, a merged rectangle keeps the place of the older one.
+ *
+ * @param dirty Pointer to the dirty list
+ * @param x0 X coordinate
+ * @param y0 Y coorginate
+ * @param w width of the rectangle
+ * @param h height of the rectangle
+ */
+void hagl_hal_dirty_add(hagl_hal_dirty_t *dirty, int16_t x0, int16_t y0, uint16_t w, uint16_t h);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* _HAGL_HAL_DIRTY_H */
@@ -68,6 +68,7 @@ extern "C" {
 #define HAGL_HAS_HAL_FLUSH
 #define HAGL_HAS_HAL_GET_PIXEL
 
+#ifndef HAGL_HAL_USE_INLINE_PIXEL
 /**
  * Put a pixel
  *
@@ -76,7 +77,20 @@ extern "C" {
  * @param color RGB565 color
  */
 void hagl_hal_put_pixel(int16_t x0, int16_t y0, color_t color);
+#endif /* HAGL_HAL_USE_INLINE_PIXEL */
 
+/**
+ * Put several pixels at once
+ *
+ * Points outside the display are skipped.
+ *
+ * @param points Pointer to count coordinates
+ * @param colors Pointer to count RGB565 colors
+ * @param count Number of pixels
+ */
+void hagl_hal_put_pixels(const point_t *points, const color_t *colors, size_t count);
+
+#ifndef HAGL_HAL_USE_INLINE_PIXEL
 /**
  * Get a single pixel
  *
@@ -88,6 +102,19 @@ void hagl_hal_put_pixel(int16_t x0, int16_t y0, color_t color);
  * @return color at the given location
  */
 color_t hagl_hal_get_pixel(int16_t x0, int16_t y0);
+#endif /* HAGL_HAL_USE_INLINE_PIXEL */
+
+#ifdef HAGL_HAL_USE_EXTERNAL_BUFFER
+/**
+ * Set memory used for the back buffer
+ *
+ * Must be called before hagl_init(). Size of the memory must be at
+ * least BITMAP_SIZE(DISPLAY_WIDTH, DISPLAY_HEIGHT, DISPLAY_DEPTH).
+ *
+ * @param memory Pointer to the memory
+ */
+void hagl_hal_set_buffer(uint8_t *memory);
+#endif /* HAGL_HAL_USE_EXTERNAL_BUFFER */
 
 /**
  * Initialize the HAL
@@ -139,6 +166,86 @@ void hagl_hal_vline(int16_t x0, int16_t y0, uint16_t h, color_t color);
  */
 size_t hagl_hal_flush();
 
+/**
+ * Flush part of the back buffer to the display
+ *
+ * @param x0 X coordinate
+ * @param y0 Y coorginate
+ * @param w width of the area
+ * @param h height of the area
+ * @return number of bytes sent
+ */
+size_t hagl_hal_flush_rect(int16_t x0, int16_t y0, uint16_t w, uint16_t h);
+
+/**
+ * Copy an area of the back buffer to another place
+ *
+ * Source and destination may overlap. Both are clipped to the current
+ * target. Use for scrolling and moving windows without redrawing. With
+ * dirty tracking the destination is marked dirty.
+ *
+ * @param x0 source X coordinate
+ * @param y0 source Y coorginate
+ * @param w width of the area
+ * @param h height of the area
+ * @param x1 destination X coordinate
+ * @param y1 destination Y coorginate
+ */
+void hagl_hal_copy_area(int16_t x0, int16_t y0, uint16_t w, uint16_t h, int16_t x1, int16_t y1);
+
+#ifdef HAGL_HAL_USE_DIRTY
+/**
+ * Mark an area to be sent on next flush
+ *
+ * With dirty tracking enabled flush sends only the marked areas.
+ *
+ * @param x0 X coordinate
+ * @param y0 Y coorginate
+ * @param w width of the area
+ * @param h height of the area
+ */
+void hagl_hal_mark_dirty(int16_t x0, int16_t y0, uint16_t w, uint16_t h);
+
+/**
+ * Set the area which is sent first by budgeted flush
+ *
+ * Dirty areas touching the focus are sent before the others. Pass zero
+ * width or height to remove the focus.
+ *
+ * @param x0 X coordinate
+ * @param y0 Y coorginate
+ * @param w width of the area
+ * @param h height of the area
+ */
+void hagl_hal_set_focus(int16_t x0, int16_t y0, uint16_t w, uint16_t h);
+
+/**
+ * Flush dirty areas within a byte budget
+ *
+ * Focused areas are sent first, then the rest oldest first. Areas are
+ * sent whole rows at a time. Rows which do not fit the budget stay dirty
+ * and are sent on the next call. At least one row is sent on each call
+ * when something is dirty, even if the row is larger than the budget, so
+ * the budget can be exceeded by at most one row.
+ *
+ * @param budget maximum number of bytes to send
+ * @return number of bytes sent
+ */
+size_t hagl_hal_flush_budget(size_t budget);
+#endif /* HAGL_HAL_USE_DIRTY */
+
+#if defined(HAGL_HAL_USE_LAYERS) || defined(HAGL_HAL_USE_SURFACES)
+/**
+ * Redirect drawing to given bitmap
+ *
+ * Coordinates are relative to the bitmap and HAGL clip window is set
+ * to the bitmap size. Pass NULL to draw to the back buffer again.
+ *
+ * @param bitmap Pointer to the target bitmap or NULL
+ */
+void hagl_hal_set_target(bitmap_t *bitmap);
+#endif /* HAGL_HAL_USE_LAYERS || HAGL_HAL_USE_SURFACES */
+
 #ifdef __cplusplus
 }
 #endif
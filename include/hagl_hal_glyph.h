@@ -0,0 +1,103 @@
+/*
+
+MIT License
+
+Copyright (c) 2021 Mika Tuupola
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+-cut-
+
+This file is part of the Kendryte K210 HAL for the HAGL graphics library:
+https://github.com/tuupola/hagl_k210_mipi
+
+SPDX-License-Identifier: MIT
+
+-cut-
+
+Glyph cache. Each glyph and color pair is rasterized once into a RGB565
+bitmap stored in a fixed size cache. Least recently used glyph is evicted
+when the cache is full. Cached glyphs are drawn with a single blit which
+in single buffered mode is one window write to the display.
+
+*/
+
+#ifndef _HAGL_HAL_GLYPH_H
+#define _HAGL_HAL_GLYPH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <wchar.h>
+
+#include "hagl_hal.h"
+
+/* Number of glyphs in the cache. */
+#ifndef HAGL_HAL_GLYPH_CACHE_COUNT
+#define HAGL_HAL_GLYPH_CACHE_COUNT  (32)
+#endif
+/* Maximum glyph size. Bigger glyphs are drawn uncached. */
+#ifndef HAGL_HAL_GLYPH_MAX_WIDTH
+#define HAGL_HAL_GLYPH_MAX_WIDTH    (16)
+#endif
+#ifndef HAGL_HAL_GLYPH_MAX_HEIGHT
+#define HAGL_HAL_GLYPH_MAX_HEIGHT   (16)
+#endif
+
+/**
+ * Draw a single character using the glyph cache
+ *
+ * Drop in replacement for hagl_put_char(). Characters which are not
+ * fully on screen are passed to hagl_put_char() which clips them.
+ * Note that the cached path does not know about the HAGL clip window.
+ *
+ * @param code Unicode code point
+ * @param x0 X coordinate
+ * @param y0 Y coorginate
+ * @param color RGB565 color
+ * @param font Pointer to a FONTX2 font
+ * @return width of the drawn character
+ */
+uint8_t hagl_hal_put_char(wchar_t code, int16_t x0, int16_t y0, color_t color, const uint8_t *font);
+
+/**
+ * Draw a string using the glyph cache
+ *
+ * Drop in replacement for hagl_put_text().
+ *
+ * @param str Pointer to a wide string
+ * @param x0 X coordinate
+ * @param y0 Y coorginate
+ * @param color RGB565 color
+ * @param font Pointer to a FONTX2 font
+ * @return width of the drawn string
+ */
+uint16_t hagl_hal_put_text(const wchar_t *str, int16_t x0, int16_t y0, color_t color, const uint8_t *font);
+
+/**
+ * Empty the glyph cache
+ */
+void hagl_hal_glyph_clear(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* _HAGL_HAL_GLYPH_H */
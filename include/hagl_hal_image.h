@@ -0,0 +1,96 @@
+/*
+
+MIT License
+
+Copyright (c) 2021 Mika Tuupola
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+-cut-
+
+This file is part of the Kendryte K210 HAL for the HAGL graphics library:
+https://github.com/tuupola/hagl_k210_mipi
+
+SPDX-License-Identifier: MIT
+
+-cut-
+
+Streaming image decoders. Compressed images are decoded a band of rows at
+a time into a small buffer which is then sent to the display, or to the
+back buffer when buffering is enabled. There is no need for a full size
+bitmap. Supported formats are QOI and a simple RLE compressed RGB565.
+
+RLE format is a sequence of packets. Each packet starts with a header
+byte. If the high bit is set the following pixel is repeated, otherwise
+the following pixels are copied. Low seven bits plus one is the number of
+pixels. Pixels are big endian RGB565.
+
+*/
+
+#ifndef _HAGL_HAL_IMAGE_H
+#define _HAGL_HAL_IMAGE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "hagl_hal.h"
+
+/* Number of rows decoded before sending. */
+#ifndef HAGL_HAL_IMAGE_LINES
+#define HAGL_HAL_IMAGE_LINES        (8)
+#endif
+
+/**
+ * Decode and draw a QOI image
+ *
+ * Image must fit the display. Alpha channel is ignored.
+ *
+ * @param x0 X coordinate
+ * @param y0 Y coorginate
+ * @param data Pointer to the QOI file
+ * @param size Size of the QOI file
+ * @return 0 on success, -1 on error
+ */
+int8_t hagl_hal_image_qoi(int16_t x0, int16_t y0, const uint8_t *data, size_t size);
+
+/**
+ * Decode and draw a RLE compressed RGB565 image
+ *
+ * Image must fit the display.
+ *
+ * @param x0 X coordinate
+ * @param y0 Y coorginate
+ * @param w width of the image
+ * @param h height of the image
+ * @param data Pointer to the compressed data
+ * @param size Size of the compressed data
+ * @return 0 on success, -1 on error
+ */
+int8_t hagl_hal_image_rle(
+    int16_t x0, int16_t y0, uint16_t w, uint16_t h, const uint8_t *data, size_t size
+);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* _HAGL_HAL_IMAGE_H */
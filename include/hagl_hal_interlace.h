@@ -0,0 +1,77 @@
+/*
+
+MIT License
+
+Copyright (c) 2021 Mika Tuupola
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+-cut-
+
+This file is part of the Kendryte K210 HAL for the HAGL graphics library:
+https://github.com/tuupola/hagl_k210_mipi
+
+SPDX-License-Identifier: MIT
+
+-cut-
+
+Interlaced flush for the double and triple buffered HALs. When enabled
+each flush sends only every other row, even rows on one frame and odd
+rows on the next. Moving content gets twice the update rate and static
+content is complete after two flushes.
+
+*/
+
+#ifndef _HAGL_HAL_INTERLACE_H
+#define _HAGL_HAL_INTERLACE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <bitmap.h>
+
+#include "hagl_hal.h"
+
+/**
+ * Enable or disable interlaced flushing
+ *
+ * Can be changed between any two flushes. First interlaced flush sends
+ * the even rows.
+ *
+ * @param enable 1 to send every other row, 0 to send whole frames
+ */
+void hagl_hal_set_interlace(uint8_t enable);
+
+/**
+ * Send the next field of a full screen bitmap to the display
+ *
+ * Sends the whole bitmap when interlacing is disabled.
+ *
+ * @param src Pointer to the bitmap
+ * @return number of bytes sent
+ */
+size_t hagl_hal_interlace_flush(bitmap_t *src);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* _HAGL_HAL_INTERLACE_H */
@@ -0,0 +1,110 @@
+/*
+
+MIT License
+
+Copyright (c) 2021 Mika Tuupola
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+-cut-
+
+This file is part of the Kendryte K210 HAL for the HAGL graphics library:
+https://github.com/tuupola/hagl_k210_mipi
+
+SPDX-License-Identifier: MIT
+
+-cut-
+
+Layer compositor for the double buffered HAL. The back buffer is used as
+a cached background which is drawn once. Overlay layers are composited on
+top of it row by row while flushing, straight into the outgoing transfer.
+The back buffer itself is never modified by the compositor.
+
+*/
+
+#ifndef _HAGL_HAL_LAYER_H
+#define _HAGL_HAL_LAYER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <bitmap.h>
+
+#include "hagl_hal.h"
+
+/* Maximum number of overlay layers. */
+#ifndef HAGL_HAL_LAYER_COUNT
+#define HAGL_HAL_LAYER_COUNT        (4)
+#endif
+/* Number of rows composited and sent at once. */
+#ifndef HAGL_HAL_LAYER_LINES
+#define HAGL_HAL_LAYER_LINES        (8)
+#endif
+
+#define HAGL_HAL_LAYER_OPAQUE       (0)
+#define HAGL_HAL_LAYER_COLOR_KEY    (1)
+#define HAGL_HAL_LAYER_MASK         (2)
+
+typedef struct {
+    bitmap_t *bitmap;
+    int16_t x0;
+    int16_t y0;
+    uint8_t mode;
+    uint8_t visible;
+    /* Pixels with this color are transparent in color key mode. */
+    color_t key;
+    /* One bit per pixel, MSB first, rows padded to full bytes. */
+    const uint8_t *mask;
+} hagl_hal_layer_t;
+
+/**
+ * Add an overlay layer
+ *
+ * Layers are composited in the order they were added, the last added
+ * layer is topmost. The layer must stay valid until it is removed.
+ *
+ * @param layer Pointer to the layer
+ */
+void hagl_hal_layer_add(hagl_hal_layer_t *layer);
+
+/**
+ * Remove an overlay layer
+ *
+ * @param layer Pointer to the layer
+ */
+void hagl_hal_layer_remove(hagl_hal_layer_t *layer);
+
+/**
+ * Composite overlay layers on top of background and send to the display
+ *
+ * Background must be full display width. Rows which are not covered by
+ * any visible layer are sent directly from the background.
+ *
+ * @param background Pointer to the background bitmap
+ * @return number of bytes sent
+ */
+size_t hagl_hal_layer_flush(bitmap_t *background);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* _HAGL_HAL_LAYER_H */
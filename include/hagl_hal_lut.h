@@ -0,0 +1,83 @@
+/*
+
+MIT License
+
+Copyright (c) 2021 Mika Tuupola
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+-cut-
+
+This file is part of the Kendryte K210 HAL for the HAGL graphics library:
+https://github.com/tuupola/hagl_k210_mipi
+
+SPDX-License-Identifier: MIT
+
+-cut-
+
+Color lookup table and brightness. When the display controller supports
+MIPI_DCS_WRITE_LUT or MIPI_DCS_SET_DISPLAY_BRIGHTNESS the change costs
+only a few command bytes. Otherwise the same effect is applied in software
+to the pixels on their way to the display. Back buffer is never modified.
+
+*/
+
+#ifndef _HAGL_HAL_LUT_H
+#define _HAGL_HAL_LUT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#include "hagl_hal.h"
+
+/* 32 red, 64 green and 32 blue entries, each 0 ... 63. */
+#define HAGL_HAL_LUT_SIZE           (128)
+
+/**
+ * Set the color lookup table
+ *
+ * Table is in MIPI_DCS_WRITE_LUT layout. Pass NULL to restore the
+ * identity table.
+ *
+ * @param lut Pointer to HAGL_HAL_LUT_SIZE bytes
+ */
+void hagl_hal_set_lut(const uint8_t *lut);
+
+/**
+ * Set the brightness
+ *
+ * @param brightness 0 is black, 255 is full brightness
+ */
+void hagl_hal_set_brightness(uint8_t brightness);
+
+/**
+ * Fill lookup table with a gamma curve
+ *
+ * @param lut Pointer to HAGL_HAL_LUT_SIZE bytes
+ * @param gamma 1.0 is the identity table
+ */
+void hagl_hal_lut_gamma(uint8_t *lut, float gamma);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* _HAGL_HAL_LUT_H */
@@ -48,6 +48,7 @@ extern "C" {
 #endif
 
 #include <stdint.h>
+#include <stddef.h>
 #include <bitmap.h>
 
 /* Define if header file included directly. */
@@ -59,9 +60,39 @@ extern "C" {
 
 #define HAGL_HAS_HAL_INIT
 #define HAGL_HAS_HAL_BLIT
+#define HAGL_HAS_HAL_SCALE_BLIT
 #define HAGL_HAS_HAL_HLINE
 #define HAGL_HAS_HAL_VLINE
 
+#if defined(HAGL_HAL_USE_QUEUE) || defined(HAGL_HAL_USE_VIEWPORTS)
+#define HAGL_HAS_HAL_FLUSH
+#endif
+
+#ifdef HAGL_HAL_USE_QUEUE
+/* Number of queued commands, must be power of two. */
+#ifndef HAGL_HAL_QUEUE_SIZE
+#define HAGL_HAL_QUEUE_SIZE         (256)
+#endif
+/* Pixels reserved for queued blits, must be power of two. */
+#ifndef HAGL_HAL_QUEUE_DATA_SIZE
+#define HAGL_HAL_QUEUE_DATA_SIZE    (4096)
+#endif
+#endif /* HAGL_HAL_USE_QUEUE */
+
+#ifdef HAGL_HAL_USE_VIEWPORTS
+/* Maximum number of buffered viewports. */
+#ifndef HAGL_HAL_VIEWPORT_COUNT
+#define HAGL_HAL_VIEWPORT_COUNT     (4)
+#endif
+
+typedef struct {
+    int16_t x0;
+    int16_t y0;
+    /* Back buffer of the viewport, size of the bitmap is size of the viewport. */
+    bitmap_t *bitmap;
+} hagl_hal_viewport_t;
+#endif /* HAGL_HAL_USE_VIEWPORTS */
+
 /**
  * Put a pixel
  *
@@ -71,6 +102,18 @@ extern "C" {
  */
 void hagl_hal_put_pixel(int16_t x0, int16_t y0, color_t color);
 
+/**
+ * Put several pixels at once
+ *
+ * Consecutive pixels on the same row are sent together. Points outside
+ * the display are skipped.
+ *
+ * @param points Pointer to count coordinates
+ * @param colors Pointer to count RGB565 colors
+ * @param count Number of pixels
+ */
+void hagl_hal_put_pixels(const point_t *points, const color_t *colors, size_t count);
+
 /**
  * Initialize the HAL
  *
@@ -80,6 +123,24 @@ void hagl_hal_put_pixel(int16_t x0, int16_t y0, color_t color);
  */
 bitmap_t *hagl_hal_init(void);
 
+#ifdef MIPI_DISPLAY_HAS_READ
+/**
+ * Copy an area of the display to another place
+ *
+ * Pixels are read back from the display memory and written again one
+ * row at a time. Source and destination may overlap. Both are clipped
+ * to the display. Buffered viewports are read as they were last flushed.
+ *
+ * @param x0 source X coordinate
+ * @param y0 source Y coorginate
+ * @param w width of the area
+ * @param h height of the area
+ * @param x1 destination X coordinate
+ * @param y1 destination Y coorginate
+ */
+void hagl_hal_copy_area(int16_t x0, int16_t y0, uint16_t w, uint16_t h, int16_t x1, int16_t y1);
+#endif /* MIPI_DISPLAY_HAS_READ */
+
 /**
  * Blit given bitmap to the display
  *
@@ -89,6 +150,35 @@ bitmap_t *hagl_hal_init(void);
  */
 void hagl_hal_blit(uint16_t x0, uint16_t y0, bitmap_t *src);
 
+/**
+ * Blit given bitmap to the display with transparent color
+ *
+ * Opaque runs of each row are sent as separate windows. Runs with same
+ * span on consecutive rows are merged to one window.
+ * Bitmap is clipped to the display.
+ *
+ * @param x0 X coordinate
+ * @param y0 Y coorginate
+ * @param src Pointer to the source bitmap
+ * @param key RGB565 color which is transparent
+ */
+void hagl_hal_blit_keyed(uint16_t x0, uint16_t y0, bitmap_t *src, color_t key);
+
+/**
+ * Blit given bitmap scaled to given dimensions to the display
+ *
+ * Address window is set once and scaled rows are streamed into it.
+ * Result is clipped to the display. Negative coordinates are accepted
+ * as their unsigned 16 bit value.
+ *
+ * @param x0 X coordinate
+ * @param y0 Y coorginate
+ * @param w new width for the bitmap
+ * @param h new height for the bitmap
+ * @param src Pointer to the source bitmap
+ */
+void hagl_hal_scale_blit(uint16_t x0, uint16_t y0, uint16_t w, uint16_t h, bitmap_t *src);
+
 /**
  * Draw a horizontal line
  *
@@ -107,6 +197,75 @@ void hagl_hal_hline(int16_t x0, int16_t y0, uint16_t w, color_t color);
  */
 void hagl_hal_vline(int16_t x0, int16_t y0, uint16_t h, color_t color);
 
+#if defined(HAGL_HAL_USE_QUEUE) || defined(HAGL_HAL_USE_VIEWPORTS)
+/**
+ * Wait until all queued commands have been sent and send buffered viewports
+ *
+ * @return number of bytes sent from viewports
+ */
+size_t hagl_hal_flush();
+#endif
+
+#ifdef HAGL_HAL_USE_VIEWPORTS
+/**
+ * Add a buffered viewport
+ *
+ * Drawing inside the viewport goes to its back buffer and is sent to the
+ * display on flush. Drawing elsewhere goes directly to the display. If
+ * viewports overlap the one added first wins. The viewport must stay
+ * valid until it is removed.
+ *
+ * @param viewport Pointer to the viewport
+ */
+void hagl_hal_viewport_add(hagl_hal_viewport_t *viewport);
+
+/**
+ * Remove a buffered viewport
+ *
+ * @param viewport Pointer to the viewport
+ */
+void hagl_hal_viewport_remove(hagl_hal_viewport_t *viewport);
+#endif /* HAGL_HAL_USE_VIEWPORTS */
+
+#ifdef HAGL_HAL_USE_QUEUE
+/**
+ * Send queued commands to the display
+ *
+ * Returns when the queue is empty. Call from exactly one consumer, for
+ * example a timer or DMA interrupt, or the second core.
+ */
+void hagl_hal_queue_process(void);
+
+/**
+ * Consumer loop for the second core
+ *
+ * Usage: register_core1(hagl_hal_queue_core1, NULL);
+ *
+ * @param ctx unused
+ * @return never returns
+ */
+int hagl_hal_queue_core1(void *ctx);
+
+/**
+ * Wait until the queue is empty
+ */
+void hagl_hal_queue_wait(void);
+
+/**
+ * Number of commands dropped because the queue was full
+ *
+ * Counts commands dropped because either the command ring or the pixel
+ * data ring had no room. Commands are dropped only if HAGL_HAL_QUEUE_DROP
+ * is defined, otherwise the caller blocks until there is room. Blits
+ * larger than HAGL_HAL_QUEUE_DATA_SIZE pixels are never queued nor
+ * dropped. The caller waits until the queue is empty and sends them
+ * directly.
+ *
+ * @return number of dropped commands
+ */
+uint32_t hagl_hal_queue_dropped(void);
+#endif /* HAGL_HAL_USE_QUEUE */
+
 #ifdef __cplusplus
 }
 #endif
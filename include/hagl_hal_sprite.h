@@ -0,0 +1,122 @@
+/*
+
+MIT License
+
+Copyright (c) 2021 Mika Tuupola
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+-cut-
+
+This file is part of the Kendryte K210 HAL for the HAGL graphics library:
+https://github.com/tuupola/hagl_k210_mipi
+
+SPDX-License-Identifier: MIT
+
+-cut-
+
+Sprite engine for the double buffered HAL. Sprites are drawn into the
+back buffer only for the duration of the flush. Pixels under each sprite
+are saved before drawing and restored right after the transfer. Only the
+old and new areas of sprites which changed are sent to the display.
+
+*/
+
+#ifndef _HAGL_HAL_SPRITE_H
+#define _HAGL_HAL_SPRITE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <bitmap.h>
+
+#include "hagl_hal.h"
+#include "hagl_hal_dirty.h"
+
+/* Maximum number of sprites. */
+#ifndef HAGL_HAL_SPRITE_COUNT
+#define HAGL_HAL_SPRITE_COUNT       (8)
+#endif
+/* Maximum sprite size. Used for the save under buffers. */
+#ifndef HAGL_HAL_SPRITE_MAX_WIDTH
+#define HAGL_HAL_SPRITE_MAX_WIDTH   (32)
+#endif
+#ifndef HAGL_HAL_SPRITE_MAX_HEIGHT
+#define HAGL_HAL_SPRITE_MAX_HEIGHT  (32)
+#endif
+
+typedef struct {
+    bitmap_t *bitmap;
+    int16_t x0;
+    int16_t y0;
+    /* Sprites with bigger z are drawn on top. */
+    uint8_t z;
+    uint8_t visible;
+    /* When set pixels with key color are transparent. */
+    uint8_t keyed;
+    color_t key;
+} hagl_hal_sprite_t;
+
+/**
+ * Add a sprite
+ *
+ * The sprite must stay valid until it is removed. Move the sprite by
+ * changing its coordinates, the change is shown on next flush. If you
+ * change the pixels of the sprite bitmap also call hagl_hal_mark_dirty().
+ *
+ * @param sprite Pointer to the sprite
+ */
+void hagl_hal_sprite_add(hagl_hal_sprite_t *sprite);
+
+/**
+ * Remove a sprite
+ *
+ * Area under the sprite is sent to the display on next flush.
+ *
+ * @param sprite Pointer to the sprite
+ */
+void hagl_hal_sprite_remove(hagl_hal_sprite_t *sprite);
+
+/**
+ * Draw sprites into the back buffer
+ *
+ * Saves the pixels under each sprite and adds the old and new area of
+ * every changed sprite to the dirty list. Called by the HAL before
+ * flushing.
+ *
+ * @param bb Pointer to the back buffer
+ * @param dirty Pointer to the dirty list
+ */
+void hagl_hal_sprite_draw(bitmap_t *bb, hagl_hal_dirty_t *dirty);
+
+/**
+ * Restore pixels under the sprites
+ *
+ * Called by the HAL after flushing.
+ *
+ * @param bb Pointer to the back buffer
+ */
+void hagl_hal_sprite_restore(bitmap_t *bb);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* _HAGL_HAL_SPRITE_H */
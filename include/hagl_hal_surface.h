@@ -0,0 +1,83 @@
+/*
+
+MIT License
+
+Copyright (c) 2021 Mika Tuupola
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+-cut-
+
+This file is part of the Kendryte K210 HAL for the HAGL graphics library:
+https://github.com/tuupola/hagl_k210_mipi
+
+SPDX-License-Identifier: MIT
+
+-cut-
+
+Offscreen surfaces for the double and triple buffered HALs. Surfaces are
+allocated from a fixed size arena instead of the heap. Draw a complex
+widget once into a surface with hagl_hal_set_target() and blit the
+surface to the back buffer every frame.
+
+*/
+
+#ifndef _HAGL_HAL_SURFACE_H
+#define _HAGL_HAL_SURFACE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <bitmap.h>
+
+#include "hagl_hal.h"
+
+/* Size of the surface arena in bytes. */
+#ifndef HAGL_HAL_SURFACE_ARENA_SIZE
+#define HAGL_HAL_SURFACE_ARENA_SIZE (64 * 1024)
+#endif
+
+/**
+ * Allocate a surface
+ *
+ * @param width width of the surface
+ * @param height height of the surface
+ * @return pointer to the surface bitmap or NULL if arena is full
+ */
+bitmap_t *hagl_hal_surface_alloc(uint16_t width, uint16_t height);
+
+/**
+ * Return a surface to the arena
+ *
+ * @param surface Pointer to a bitmap returned by hagl_hal_surface_alloc()
+ */
+void hagl_hal_surface_free(bitmap_t *surface);
+
+/**
+ * Free all surfaces at once
+ */
+void hagl_hal_surface_reset(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* _HAGL_HAL_SURFACE_H */
@@ -0,0 +1,139 @@
+/*
+
+MIT License
+
+Copyright (c) 2021 Mika Tuupola
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+-cut-
+
+This file is part of the Kendryte K210 HAL for the HAGL graphics library:
+https://github.com/tuupola/hagl_k210_mipi
+
+SPDX-License-Identifier: MIT
+
+-cut-
+
+Tiled back buffer layout for the double and triple buffered HALs. Pixels
+are stored in small tiles instead of rows, so vertical and otherwise 2D
+local drawing touches fewer cache lines. Tiles are stored row by row and
+pixels inside a tile also row by row. When flushing the tiles are turned
+back into rows through a small staging buffer.
+
+*/
+
+#ifndef _HAGL_HAL_TILE_H
+#define _HAGL_HAL_TILE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <bitmap.h>
+
+#include "hagl_hal.h"
+
+/* Size of a tile in pixels, must be powers of two. */
+#ifndef HAGL_HAL_TILE_WIDTH
+#define HAGL_HAL_TILE_WIDTH         (8)
+#endif
+#ifndef HAGL_HAL_TILE_HEIGHT
+#define HAGL_HAL_TILE_HEIGHT        (8)
+#endif
+
+#define HAGL_HAL_TILE_SIZE          (HAGL_HAL_TILE_WIDTH * HAGL_HAL_TILE_HEIGHT)
+
+static inline color_t *hagl_hal_tile_address(bitmap_t *bitmap, uint16_t x0, uint16_t y0)
+{
+    uint32_t tile = (y0 / HAGL_HAL_TILE_HEIGHT) * (bitmap->width / HAGL_HAL_TILE_WIDTH)
+        + x0 / HAGL_HAL_TILE_WIDTH;
+    return (color_t *) bitmap->buffer + tile * HAGL_HAL_TILE_SIZE
+        + (y0 % HAGL_HAL_TILE_HEIGHT) * HAGL_HAL_TILE_WIDTH
+        + x0 % HAGL_HAL_TILE_WIDTH;
+}
+
+/**
+ * Draw a horizontal line to tiled bitmap
+ *
+ * @param dst Pointer to the tiled bitmap
+ * @param x0 X coordinate
+ * @param y0 Y coorginate
+ * @param w width of the line
+ * @param color RGB565 color
+ */
+void hagl_hal_tile_hline(bitmap_t *dst, uint16_t x0, uint16_t y0, uint16_t w, color_t color);
+
+/**
+ * Draw a vertical line to tiled bitmap
+ *
+ * @param dst Pointer to the tiled bitmap
+ * @param x0 X coordinate
+ * @param y0 Y coorginate
+ * @param h height of the line
+ * @param color RGB565 color
+ */
+void hagl_hal_tile_vline(bitmap_t *dst, uint16_t x0, uint16_t y0, uint16_t h, color_t color);
+
+/**
+ * Blit row ordered bitmap to tiled bitmap
+ *
+ * Source is clipped to the tiled bitmap, coordinates may be negative.
+ *
+ * @param dst Pointer to the tiled bitmap
+ * @param x0 X coordinate
+ * @param y0 Y coorginate
+ * @param src Pointer to the source bitmap
+ */
+void hagl_hal_tile_blit(bitmap_t *dst, int16_t x0, int16_t y0, bitmap_t *src);
+
+/**
+ * Blit row ordered bitmap scaled to given dimensions to tiled bitmap
+ *
+ * Scaled bitmap is clipped to the tiled bitmap, coordinates may be negative.
+ *
+ * @param dst Pointer to the tiled bitmap
+ * @param x0 X coordinate
+ * @param y0 Y coorginate
+ * @param w new width for the bitmap
+ * @param h new height for the bitmap
+ * @param src Pointer to the source bitmap
+ */
+void hagl_hal_tile_scale_blit(
+    bitmap_t *dst, int16_t x0, int16_t y0, uint16_t w, uint16_t h, bitmap_t *src
+);
+
+/**
+ * Send an area of tiled bitmap to the display
+ *
+ * @param src Pointer to the tiled bitmap
+ * @param x0 X coordinate
+ * @param y0 Y coorginate
+ * @param w width of the area
+ * @param h height of the area
+ * @return number of bytes sent
+ */
+size_t hagl_hal_tile_write(bitmap_t *src, uint16_t x0, uint16_t y0, uint16_t w, uint16_t h);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* _HAGL_HAL_TILE_H */
@@ -0,0 +1,107 @@
+/*
+
+MIT License
+
+Copyright (c) 2021 Mika Tuupola
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+-cut-
+
+This file is part of the Kendryte K210 HAL for the HAGL graphics library:
+https://github.com/tuupola/hagl_k210_mipi
+
+SPDX-License-Identifier: MIT
+
+-cut-
+
+Timeline tracing for latency hunting. Begin and end events are stored with
+a timestamp and core id to a fixed size ring buffer. When the ring is full
+the oldest events are overwritten. The ring can be dumped as Chrome trace
+event JSON which can be opened in chrome://tracing or Perfetto.
+
+When HAGL_HAL_USE_TRACE is not defined the macros compile to nothing.
+
+*/
+
+#ifndef _HAGL_HAL_TRACE_H
+#define _HAGL_HAL_TRACE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef HAGL_HAL_USE_TRACE
+
+/* Number of events kept, must be power of two. */
+#ifndef HAGL_HAL_TRACE_SIZE
+#define HAGL_HAL_TRACE_SIZE         (512)
+#endif
+
+#define HAGL_HAL_TRACE_BEGIN(name)          hagl_hal_trace(name, 'B')
+#define HAGL_HAL_TRACE_END(name)            hagl_hal_trace(name, 'E')
+/* For spans which start and end in different calls, such as DMA. */
+#define HAGL_HAL_TRACE_ASYNC_BEGIN(name)    hagl_hal_trace(name, 'b')
+#define HAGL_HAL_TRACE_ASYNC_END(name)      hagl_hal_trace(name, 'e')
+/* For single points in time, such as TE edges. */
+#define HAGL_HAL_TRACE_INSTANT(name)        hagl_hal_trace(name, 'i')
+
+/**
+ * Store an event to the ring buffer
+ *
+ * Safe to call from both cores and interrupt handlers. Name must be
+ * a string literal or otherwise stay valid until dumped.
+ *
+ * @param name Name of the event
+ * @param phase Chrome trace event phase
+ */
+void hagl_hal_trace(const char *name, char phase);
+
+/**
+ * Remove all events from the ring buffer
+ */
+void hagl_hal_trace_clear(void);
+
+/**
+ * Write the ring buffer as Chrome trace event JSON
+ *
+ * On device pass stdout to dump over UART. In host builds pass a file.
+ * Events stored while dumping might be garbled.
+ *
+ * @param stream Where to write the JSON
+ */
+void hagl_hal_trace_dump(FILE *stream);
+
+#else
+
+#define HAGL_HAL_TRACE_BEGIN(name)
+#define HAGL_HAL_TRACE_END(name)
+#define HAGL_HAL_TRACE_ASYNC_BEGIN(name)
+#define HAGL_HAL_TRACE_ASYNC_END(name)
+#define HAGL_HAL_TRACE_INSTANT(name)
+
+#endif /* HAGL_HAL_USE_TRACE */
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* _HAGL_HAL_TRACE_H */
@@ -68,6 +68,11 @@ extern "C" {
 #define HAGL_HAS_HAL_FLUSH
 #define HAGL_HAS_HAL_GET_PIXEL
 
+#ifdef HAGL_HAL_USE_BUFFER_AGE
+#include "hagl_hal_dirty.h"
+#endif /* HAGL_HAL_USE_BUFFER_AGE */
+
+#ifndef HAGL_HAL_USE_INLINE_PIXEL
 /**
  * Put a pixel
  *
@@ -76,7 +81,20 @@ extern "C" {
  * @param color RGB565 color
  */
 void hagl_hal_put_pixel(int16_t x0, int16_t y0, color_t color);
+#endif /* HAGL_HAL_USE_INLINE_PIXEL */
+
+/**
+ * Put several pixels at once
+ *
+ * Points outside the display are skipped.
+ *
+ * @param points Pointer to count coordinates
+ * @param colors Pointer to count RGB565 colors
+ * @param count Number of pixels
+ */
+void hagl_hal_put_pixels(const point_t *points, const color_t *colors, size_t count);
 
+#ifndef HAGL_HAL_USE_INLINE_PIXEL
 /**
  * Get a single pixel
  *
@@ -88,6 +106,20 @@ void hagl_hal_put_pixel(int16_t x0, int16_t y0, color_t color);
  * @return color at the given location
  */
 color_t hagl_hal_get_pixel(int16_t x0, int16_t y0);
+#endif /* HAGL_HAL_USE_INLINE_PIXEL */
+
+#ifdef HAGL_HAL_USE_EXTERNAL_BUFFER
+/**
+ * Set memory used for the back buffers
+ *
+ * Must be called before hagl_init(). Size of each memory block must be
+ * at least BITMAP_SIZE(DISPLAY_WIDTH, DISPLAY_HEIGHT, DISPLAY_DEPTH).
+ *
+ * @param memory1 Pointer to the memory of first back buffer
+ * @param memory2 Pointer to the memory of second back buffer
+ */
+void hagl_hal_set_buffers(uint8_t *memory1, uint8_t *memory2);
+#endif /* HAGL_HAL_USE_EXTERNAL_BUFFER */
 
 /**
  * Initialize the HAL
@@ -139,6 +171,88 @@ void hagl_hal_vline(int16_t x0, int16_t y0, uint16_t h, color_t color);
  */
 size_t hagl_hal_flush();
 
+/**
+ * Flush part of the back buffer to the display
+ *
+ * Sends from the current back buffer and does not swap the buffers.
+ *
+ * @param x0 X coordinate
+ * @param y0 Y coorginate
+ * @param w width of the area
+ * @param h height of the area
+ * @return number of bytes sent
+ */
+size_t hagl_hal_flush_rect(int16_t x0, int16_t y0, uint16_t w, uint16_t h);
+
+/**
+ * Copy an area of the back buffer to another place
+ *
+ * Source and destination may overlap. Both are clipped to the current
+ * target. Use for scrolling and moving windows without redrawing. With
+ * buffer age the destination is added to the damage.
+ *
+ * When drawing to the back buffer the source is read from the frame
+ * flushed last, ie. what is on the display. Back buffer itself holds the
+ * frame before that. Drawing done to the source area since the last
+ * flush is not copied.
+ *
+ * @param x0 source X coordinate
+ * @param y0 source Y coorginate
+ * @param w width of the area
+ * @param h height of the area
+ * @param x1 destination X coordinate
+ * @param y1 destination Y coorginate
+ */
+void hagl_hal_copy_area(int16_t x0, int16_t y0, uint16_t w, uint16_t h, int16_t x1, int16_t y1);
+
+#ifdef HAGL_HAL_USE_BUFFER_AGE
+/**
+ * Report an area drawn during the current frame
+ *
+ * All drawing must be reported for the damage history to be correct.
+ *
+ * @param x0 X coordinate
+ * @param y0 Y coorginate
+ * @param w width of the area
+ * @param h height of the area
+ */
+void hagl_hal_add_damage(int16_t x0, int16_t y0, uint16_t w, uint16_t h);
+
+/**
+ * Get the age of the current back buffer
+ *
+ * Age is the number of frames since the content of the back buffer was
+ * sent to the display. Age 0 means the content is undefined. With triple
+ * buffering the age is normally 2.
+ *
+ * @return age of the back buffer
+ */
+uint8_t hagl_hal_buffer_age(void);
+
+/**
+ * Get the areas which changed since the back buffer was last drawn
+ *
+ * This is the damage of the previous age - 1 frames. Redrawing these
+ * areas brings the back buffer up to date with the display. With age 0
+ * the whole display is returned.
+ *
+ * @param damage Pointer to the list to fill
+ */
+void hagl_hal_buffer_damage(hagl_hal_dirty_t *damage);
+#endif /* HAGL_HAL_USE_BUFFER_AGE */
+
+#ifdef HAGL_HAL_USE_SURFACES
+/**
+ * Redirect drawing to given bitmap
+ *
+ * Coordinates are relative to the bitmap and HAGL clip window is set
+ * to the bitmap size. Pass NULL to draw to the back buffer again.
+ *
+ * @param bitmap Pointer to the target bitmap or NULL
+ */
+void hagl_hal_set_target(bitmap_t *bitmap);
+#endif /* HAGL_HAL_USE_SURFACES */
+
 #ifdef __cplusplus
 }
 #endif
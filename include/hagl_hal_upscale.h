@@ -0,0 +1,72 @@
+/*
+
+MIT License
+
+Copyright (c) 2021 Mika Tuupola
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+-cut-
+
+This file is part of the Kendryte K210 HAL for the HAGL graphics library:
+https://github.com/tuupola/hagl_k210_mipi
+
+SPDX-License-Identifier: MIT
+
+-cut-
+
+Low resolution back buffer for the double and triple buffered HALs. The
+back buffer is HAGL_HAL_UPSCALE times smaller in both directions. When
+flushing each row is widened to a line buffer which is then sent as many
+times as needed. With DMA the next row is widened while the previous one
+is being sent.
+
+*/
+
+#ifndef _HAGL_HAL_UPSCALE_H
+#define _HAGL_HAL_UPSCALE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <bitmap.h>
+
+#include "hagl_hal.h"
+
+/**
+ * Send an area of low resolution bitmap upscaled to the display
+ *
+ * Coordinates are in the low resolution.
+ *
+ * @param src Pointer to the low resolution bitmap
+ * @param x0 X coordinate
+ * @param y0 Y coorginate
+ * @param w width of the area
+ * @param h height of the area
+ * @return number of bytes sent
+ */
+size_t hagl_hal_upscale_write(bitmap_t *src, uint16_t x0, uint16_t y0, uint16_t w, uint16_t h);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* _HAGL_HAL_UPSCALE_H */
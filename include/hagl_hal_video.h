@@ -0,0 +1,116 @@
+/*
+
+MIT License
+
+Copyright (c) 2021 Mika Tuupola
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+-cut-
+
+This file is part of the Kendryte K210 HAL for the HAGL graphics library:
+https://github.com/tuupola/hagl_k210_mipi
+
+SPDX-License-Identifier: MIT
+
+-cut-
+
+Playback of raw RGB565 video. Frames are read in strips of rows to two
+buffers. While one strip is being sent to the display the next one is
+being read. For real overlap register hagl_hal_video_core1() to the second
+core, otherwise strips are sent from the same core in between reads.
+
+Each frame is either raw rows, or with delta encoding a bitmask of changed
+rows, one bit per row MSB first, followed by the changed rows only.
+
+*/
+
+#ifndef _HAGL_HAL_VIDEO_H
+#define _HAGL_HAL_VIDEO_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "hagl_hal.h"
+
+/* Returns number of bytes read, less than size at the end of the video. */
+typedef size_t (*hagl_hal_video_read_t)(uint8_t *buffer, size_t size, void *ctx);
+
+typedef struct {
+    int16_t x0;
+    int16_t y0;
+    uint16_t width;
+    uint16_t height;
+    /* Two strip buffers, each size bytes and at least one row. */
+    uint8_t *buffers[2];
+    size_t size;
+    /* Frames are delta encoded. */
+    uint8_t delta;
+    hagl_hal_video_read_t read;
+    void *ctx;
+} hagl_hal_video_t;
+
+/**
+ * Play the video until the read callback runs out of data
+ *
+ * Video must fit on the display, otherwise nothing is played.
+ *
+ * @param video Pointer to the video
+ * @return number of frames played
+ */
+uint32_t hagl_hal_video_play(hagl_hal_video_t *video);
+
+/**
+ * Strip presenter loop for the second core
+ *
+ * Usage: register_core1(hagl_hal_video_core1, NULL);
+ *
+ * @param ctx unused
+ * @return never returns
+ */
+int hagl_hal_video_core1(void *ctx);
+
+#ifndef __riscv
+/**
+ * Read the video from a memory mapped file
+ *
+ * For benchmarking in host builds. Sets the read callback.
+ *
+ * @param video Pointer to the video
+ * @param path Path to the file
+ * @return 0 on success, -1 on error
+ */
+int8_t hagl_hal_video_mmap(hagl_hal_video_t *video, const char *path);
+
+/**
+ * Unmap the file mapped with hagl_hal_video_mmap()
+ *
+ * @param video Pointer to the video
+ */
+void hagl_hal_video_munmap(hagl_hal_video_t *video);
+#endif /* __riscv */
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* _HAGL_HAL_VIDEO_H */
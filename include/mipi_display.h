@@ -43,8 +43,19 @@ extern "C" {
 
 #include "hagl_hal.h"
 
+/* Transforms size bytes of pixels from src to dst on the way to the display. */
+typedef void (*mipi_display_transform_t)(uint8_t *dst, const uint8_t *src, size_t size, void *ctx);
+
 void mipi_display_init();
 size_t mipi_display_write(uint16_t x1, uint16_t y1, uint16_t w, uint16_t h, uint8_t *buffer);
+size_t mipi_display_write_pitch(uint16_t x1, uint16_t y1, uint16_t w, uint16_t h, size_t pitch, uint8_t *buffer);
+#ifdef MIPI_DISPLAY_HAS_READ
+size_t mipi_display_read(uint16_t x1, uint16_t y1, uint16_t w, uint16_t h, uint8_t *buffer);
+#endif /* MIPI_DISPLAY_HAS_READ */
+void mipi_display_stream_begin(uint16_t x1, uint16_t y1, uint16_t w, uint16_t h);
+size_t mipi_display_stream_write(uint8_t *buffer, size_t size);
+void mipi_display_stream_end();
+void mipi_display_set_transform(mipi_display_transform_t transform, void *ctx);
 void mipi_display_ioctl(uint8_t command, uint8_t *data, size_t size);
 void mipi_display_close();
 
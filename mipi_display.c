@@ -31,6 +31,7 @@ SPDX-License-Identifier: MIT
 
 */
 
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -39,12 +40,122 @@ SPDX-License-Identifier: MIT
 #include <fpioa.h>
 #include <sysctl.h>
 #include <gpiohs.h>
+#include <dmac.h>
 
 #include "mipi_dcs.h"
 #include "mipi_display.h"
 
+/* DMA is used only for flushing the back buffers. */
+#if defined(HAGL_HAS_HAL_BACK_BUFFER) && defined(HAGL_HAL_USE_DMA)
+#define MIPI_DISPLAY_USE_DMA
+#endif
+
+static mipi_display_transform_t transform = NULL;
+static void *transform_ctx = NULL;
+
+#ifdef MIPI_DISPLAY_USE_DMA
+/*
+SPI is in eight bit mode but the DMA writes 32 bit words to the FIFO. Each
+byte is widened to a word in one of two staging buffers while the other
+one is being sent. This hides the conversion behind bus time.
+*/
+static uint32_t stage[2][MIPI_DISPLAY_CHUNK_SIZE] __attribute__((aligned(64)));
+static uint8_t current = 0;
+static volatile bool busy = false;
+
+#ifdef HAGL_HAL_USE_UNCACHED_DMA
+/* SRAM is mapped also uncached 0x40000000 lower. */
+static uint32_t *mipi_display_uncached(uint32_t *buffer)
+{
+    uintptr_t address = (uintptr_t) buffer;
+    if (address >= 0x80000000 && address < 0x80800000) {
+        address -= 0x40000000;
+    }
+    return (uint32_t *) address;
+}
+#endif /* HAGL_HAL_USE_UNCACHED_DMA */
+
+static void mipi_display_dma_wait()
+{
+    volatile spi_t *spi_handle = spi[MIPI_DISPLAY_SPI_CHANNEL];
+
+    if (!busy) {
+        return;
+    }
+
+    dmac_wait_done(MIPI_DISPLAY_DMA_CHANNEL);
+    HAGL_HAL_TRACE_ASYNC_END("dma");
+
+    /* Wait until FIFO is empty and SPI is idle. */
+    while ((spi_handle->sr & 0x05) != 0x04) {
+    }
+    spi_handle->ser = 0x00;
+    spi_handle->ssienr = 0x00;
+
+    busy = false;
+}
+
+/* Same as spi_send_data_normal_dma() but does not wait or allocate. */
+static void mipi_display_dma_start(const uint32_t *words, size_t count)
+{
+    volatile spi_t *spi_handle = spi[MIPI_DISPLAY_SPI_CHANNEL];
+
+    /* Set DC high to denote incoming data. */
+    gpiohs_set_pin(MIPI_DISPLAY_GPIO_DC, GPIO_PV_HIGH);
+
+    /* Transfer mode is already transmit only since data always follows a command. */
+    spi_handle->dmacr = 0x2;
+    spi_handle->ssienr = 0x01;
+
+    sysctl_dma_select(
+        (sysctl_dma_channel_t) MIPI_DISPLAY_DMA_CHANNEL,
+        SYSCTL_DMA_SELECT_SSI0_TX_REQ + MIPI_DISPLAY_SPI_CHANNEL * 2
+    );
+    dmac_set_single_mode(
+        MIPI_DISPLAY_DMA_CHANNEL, words, (void *)(&spi_handle->dr[0]),
+        DMAC_ADDR_INCREMENT, DMAC_ADDR_NOCHANGE, DMAC_MSIZE_4, DMAC_TRANS_WIDTH_32, count
+    );
+
+    busy = true;
+    HAGL_HAL_TRACE_ASYNC_BEGIN("dma");
+    spi_handle->ser = 1U << MIPI_DISPLAY_SPI_SS;
+}
+
+static void mipi_display_write_data_dma(const uint8_t *buffer, size_t length)
+{
+    while (length) {
+        size_t size = length < MIPI_DISPLAY_CHUNK_SIZE ? length : MIPI_DISPLAY_CHUNK_SIZE;
+        uint32_t *words = stage[current];
+
+#ifdef HAGL_HAL_USE_UNCACHED_DMA
+        /*
+         * Staging writes bypass the cache so they do not evict hot data.
+         * The source is still read cached, it may hold lines the CPU has
+         * just drawn and not yet written back.
+         */
+        words = mipi_display_uncached(words);
+#endif /* HAGL_HAL_USE_UNCACHED_DMA */
+
+        for (size_t i = 0; i < size; i++) {
+            words[i] = buffer[i];
+        }
+
+        mipi_display_dma_wait();
+        mipi_display_dma_start(words, size);
+
+        current ^= 1;
+        buffer += size;
+        length -= size;
+    }
+}
+#endif /* MIPI_DISPLAY_USE_DMA */
+
 static void mipi_display_write_command(const uint8_t command)
 {
+#ifdef MIPI_DISPLAY_USE_DMA
+    mipi_display_dma_wait();
+#endif /* MIPI_DISPLAY_USE_DMA */
+
     /* Set DC low to denote incoming command. */
     gpiohs_set_pin(MIPI_DISPLAY_GPIO_DC, GPIO_PV_LOW);
 
@@ -62,6 +173,10 @@ static void mipi_display_write_data(const uint8_t *data, size_t length)
         return;
     };
 
+#ifdef MIPI_DISPLAY_USE_DMA
+    mipi_display_dma_wait();
+#endif /* MIPI_DISPLAY_USE_DMA */
+
     /* Set DC high to denote incoming data. */
     gpiohs_set_pin(MIPI_DISPLAY_GPIO_DC, GPIO_PV_HIGH);
 
@@ -71,32 +186,35 @@ static void mipi_display_write_data(const uint8_t *data, size_t length)
     );
 }
 
-static void mipi_display_write_data_dma(const uint8_t *buffer, size_t length)
+static void mipi_display_read_data(const uint8_t command, uint8_t *data, size_t length)
 {
+#ifdef MIPI_DISPLAY_HAS_READ
     if (0 == length) {
+        mipi_display_write_command(command);
         return;
-    };
+    }
 
-    /* Set DC high to denote incoming data. */
-    gpiohs_set_pin(MIPI_DISPLAY_GPIO_DC, GPIO_PV_HIGH);
+#ifdef MIPI_DISPLAY_USE_DMA
+    mipi_display_dma_wait();
+#endif /* MIPI_DISPLAY_USE_DMA */
 
-    /* CS is handled automatically by the sending function. */
-    /* This function seems to wait until transfer is finished. Write your own one? */
-    /* https://github.com/kendryte/kendryte-standalone-sdk/blob/develop/lib/drivers/spi.c#L446 */
-    spi_send_data_normal_dma(
-        DMAC_CHANNEL0, MIPI_DISPLAY_SPI_CHANNEL, MIPI_DISPLAY_SPI_SS, buffer, length, SPI_TRANS_CHAR
-    );
-}
+    /* Set DC low to denote the command. It is not sampled while reading. */
+    gpiohs_set_pin(MIPI_DISPLAY_GPIO_DC, GPIO_PV_LOW);
 
-static void mipi_display_read_data(uint8_t *data, size_t length)
-{
-    if (0 == length) {
-        return;
-    };
+    /*
+     * Releasing CS between the command and the data aborts the read so
+     * both go in the same transfer.
+     */
+    spi_receive_data_standard(
+        MIPI_DISPLAY_SPI_CHANNEL, MIPI_DISPLAY_SPI_SS, &command, 1, data, length
+    );
+#else
+    /* Without a read line only the command is sent. */
+    mipi_display_write_command(command);
+#endif /* MIPI_DISPLAY_HAS_READ */
 }
 
-static void mipi_display_set_address(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2) {
-    uint8_t command;
+static void mipi_display_set_window(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2) {
     uint8_t data[4];
     static uint16_t prev_x1, prev_x2, prev_y1, prev_y2;
 
@@ -130,8 +248,15 @@ static void mipi_display_set_address(uint16_t x1, uint16_t y1, uint16_t x2, uint
         prev_y1 = y1;
         prev_y2 = y2;
     }
+}
 
+static void mipi_display_set_address(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2) {
+    HAGL_HAL_TRACE_BEGIN("mipi_display_set_address");
+
+    mipi_display_set_window(x1, y1, x2, y2);
     mipi_display_write_command(MIPI_DCS_WRITE_MEMORY_START);
+
+    HAGL_HAL_TRACE_END("mipi_display_set_address");
 }
 
 static void mipi_display_power_init() {
@@ -191,6 +316,10 @@ void mipi_display_init()
 #endif /* HAGL_HAL_USE_DMA */
 #endif /* HAGL_HAL_USE_TRIPLE_BUFFER */
 
+#ifdef HAGL_HAL_USE_DYNAMIC_BUFFER
+    hagl_hal_debug("%s\n", "Initialising display with runtime selectable buffering.");
+#endif /* HAGL_HAL_USE_DYNAMIC_BUFFER */
+
     mipi_display_power_init();
     mipi_display_spi_master_init();
 
@@ -243,29 +372,121 @@ void mipi_display_init()
 
 size_t mipi_display_write(uint16_t x1, uint16_t y1, uint16_t w, uint16_t h, uint8_t *buffer)
 {
+    size_t sent;
+
     if (0 == w || 0 == h) {
         return 0;
     }
 
-    int32_t x2 = x1 + w - 1;
-    int32_t y2 = y1 + h - 1;
-    uint32_t size = w * h;
+    HAGL_HAL_TRACE_BEGIN("mipi_display_write");
+    mipi_display_stream_begin(x1, y1, w, h);
+    sent = mipi_display_stream_write(buffer, w * h * DISPLAY_DEPTH / 8);
+    mipi_display_stream_end();
+    HAGL_HAL_TRACE_END("mipi_display_write");
 
-#ifdef HAGL_HAL_USE_SINGLE_BUFFER
-    mipi_display_set_address(x1, y1, x2, y2);
-    mipi_display_write_data(buffer, size * DISPLAY_DEPTH / 8);
-#endif /* HAGL_HAL_SINGLE_BUFFER */
+    /* This should also include the bytes for writing the commands. */
+    return sent;
+}
 
-#ifdef HAGL_HAS_HAL_BACK_BUFFER
-    mipi_display_set_address(x1, y1, x2, y2);
-#ifdef HAGL_HAL_USE_DMA
-    mipi_display_write_data_dma(buffer, size * DISPLAY_DEPTH / 8);
+size_t mipi_display_write_pitch(uint16_t x1, uint16_t y1, uint16_t w, uint16_t h, size_t pitch, uint8_t *buffer)
+{
+    size_t size = w * DISPLAY_DEPTH / 8;
+    size_t sent = 0;
+
+    if (0 == w || 0 == h) {
+        return 0;
+    }
+
+    /* Rows are streamed into one window, no staging copy is needed. */
+    mipi_display_stream_begin(x1, y1, w, h);
+    if (pitch == size) {
+        sent = mipi_display_stream_write(buffer, size * h);
+    } else {
+        for (uint16_t y = 0; y < h; y++) {
+            sent += mipi_display_stream_write(buffer, size);
+            buffer += pitch;
+        }
+    }
+    mipi_display_stream_end();
+
+    return sent;
+}
+
+#ifdef MIPI_DISPLAY_HAS_READ
+size_t mipi_display_read(uint16_t x1, uint16_t y1, uint16_t w, uint16_t h, uint8_t *buffer)
+{
+    /* One dummy byte followed by three bytes per pixel. */
+    static uint8_t rgb[1 + 3 * MIPI_DISPLAY_WIDTH];
+
+    if (0 == w || 0 == h) {
+        return 0;
+    }
+
+    /* Each row is read separately so the staging buffer stays small. */
+    for (uint16_t y = y1; y < y1 + h; y++) {
+        mipi_display_set_window(x1, y, x1 + w - 1, y);
+        mipi_display_read_data(MIPI_DCS_READ_MEMORY_START, rgb, 1 + 3 * w);
+
+        /* Controller returns RGB666 even in 16 bit mode. */
+        for (uint16_t x = 0; x < w; x++) {
+            uint8_t *src = &rgb[1 + 3 * x];
+            uint16_t color = ((src[0] & 0xf8) << 8) | ((src[1] & 0xfc) << 3) | (src[2] >> 3);
+            *buffer++ = color >> 8;
+            *buffer++ = color & 0xff;
+        }
+    }
+
+    return w * h * DISPLAY_DEPTH / 8;
+}
+#endif /* MIPI_DISPLAY_HAS_READ */
+
+void mipi_display_stream_begin(uint16_t x1, uint16_t y1, uint16_t w, uint16_t h)
+{
+    /* Pixels sent after this wrap inside the window row by row. */
+    mipi_display_set_address(x1, y1, x1 + w - 1, y1 + h - 1);
+}
+
+size_t mipi_display_stream_write(uint8_t *buffer, size_t size)
+{
+    static uint8_t pixels[MIPI_DISPLAY_CHUNK_SIZE];
+
+    if (NULL == transform) {
+#ifdef MIPI_DISPLAY_USE_DMA
+        mipi_display_write_data_dma(buffer, size);
 #else
-    mipi_display_write_data(buffer, size * DISPLAY_DEPTH / 8);
-#endif /* HAGL_HAL_USE_DMA */
-#endif /* HAGL_HAS_HAL_BACK_BUFFER */
-    /* This should also include the bytes for writing the commands. */
-    return size * DISPLAY_DEPTH / 8;
+        mipi_display_write_data(buffer, size);
+#endif /* MIPI_DISPLAY_USE_DMA */
+        return size;
+    }
+
+    /* Transform chunk by chunk, the source buffer is never modified. */
+    for (size_t offset = 0; offset < size; offset += MIPI_DISPLAY_CHUNK_SIZE) {
+        size_t length = size - offset;
+        if (length > MIPI_DISPLAY_CHUNK_SIZE) {
+            length = MIPI_DISPLAY_CHUNK_SIZE;
+        }
+        transform(pixels, buffer + offset, length, transform_ctx);
+#ifdef MIPI_DISPLAY_USE_DMA
+        mipi_display_write_data_dma(pixels, length);
+#else
+        mipi_display_write_data(pixels, length);
+#endif /* MIPI_DISPLAY_USE_DMA */
+    }
+
+    return size;
+}
+
+void mipi_display_stream_end()
+{
+#ifdef MIPI_DISPLAY_USE_DMA
+    mipi_display_dma_wait();
+#endif /* MIPI_DISPLAY_USE_DMA */
+}
+
+void mipi_display_set_transform(mipi_display_transform_t function, void *ctx)
+{
+    transform = function;
+    transform_ctx = ctx;
 }
 
 /* TODO: This most likely does not work with dma atm. */
@@ -290,8 +511,7 @@ void mipi_display_ioctl(const uint8_t command, uint8_t *data, size_t size)
         case MIPI_DCS_GET_POWER_SAVE:
         case MIPI_DCS_READ_DDB_START:
         case MIPI_DCS_READ_DDB_CONTINUE:
-            mipi_display_write_command(command);
-            mipi_display_read_data(data, size);
+            mipi_display_read_data(command, data, size);
             break;
         default:
             mipi_display_write_command(command);